@@ -1,66 +1,2067 @@
+#include <errno.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <locale.h> // strtod_l
+#ifdef __APPLE__
+#include <xlocale.h>
+#endif
+#include <emmintrin.h> // SSE2, part of every x64 target
+#if defined(__AVX2__) || defined(__F16C__)
+#include <immintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static inline unsigned int ctz64(uint64_t x) {
+#ifdef _MSC_VER
+    unsigned long i; _BitScanForward64(&i, x); return i;
+#else
+    return __builtin_ctzll(x);
+#endif
+}
+
+static inline unsigned int clz64(uint64_t x) {
+#ifdef _MSC_VER
+    unsigned long i; _BitScanReverse64(&i, x); return 63 - i;
+#else
+    return __builtin_clzll(x);
+#endif
+}
+
+static inline unsigned int popcount64(uint64_t x) {
+#ifdef _MSC_VER
+    return (unsigned int)__popcnt64(x);
+#else
+    return __builtin_popcountll(x);
+#endif
+}
+
+// the 128 bit product a * b, returns the lower half
+static inline uint64_t mul128(uint64_t a, uint64_t b, uint64_t* hi) {
+#ifdef _MSC_VER
+    return _umul128(a, b, hi);
+#else
+    const unsigned __int128 p = (unsigned __int128)a * b;
+    *hi = (uint64_t)(p >> 64);
+    return (uint64_t)p;
+#endif
+}
+
+static const uint64_t pow10_u64[20] = {
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull,
+    10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull, 100000000000000ull, 1000000000000000ull,
+    10000000000000000ull, 100000000000000000ull, 1000000000000000000ull, 10000000000000000000ull
+};
+
+static inline bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static inline bool is_separator(char c, char delim) {
+    return c == delim || c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+// Correctly rounded decimal parsing
+// w * 10^q is converted with the Eisel-Lemire algorithm (Daniel Lemire, "Number Parsing at a Gigabyte per Second"):
+// one or two 64x64->128 bit multiplications with a 128 bit truncated power of five decide the result
+
+// w * 10^q
+struct decimal_number {
+    uint64_t w; // the first 19 significant digits
+    int64_t q;
+    bool negative;
+    bool truncated; // more nonzero digits followed w
+};
+
+template<typename T> struct binary_format;
+
+template<> struct binary_format<double> {
+    typedef uint64_t bits;
+    static const int mantissa_bits = 52, minimum_exponent = -1023, infinite_power = 0x7ff;
+    static const int smallest_power_of_ten = -342, largest_power_of_ten = 308;
+    static const int min_exponent_round_to_even = -4, max_exponent_round_to_even = 23;
+    // w * 10^q is exact with one rounding in double arithmetic (Clinger's fast path)
+    static const int max_exponent_fast_path = 22;
+    static const uint64_t max_mantissa_fast_path = 1ull << 53;
+};
+
+template<> struct binary_format<float> {
+    typedef uint32_t bits;
+    static const int mantissa_bits = 23, minimum_exponent = -127, infinite_power = 0xff;
+    static const int smallest_power_of_ten = -65, largest_power_of_ten = 38;
+    static const int min_exponent_round_to_even = -17, max_exponent_round_to_even = 10;
+    static const int max_exponent_fast_path = 10;
+    static const uint64_t max_mantissa_fast_path = 1ull << 24;
+};
+
+// 1e0 ... 1e22 are exactly representable as double, 1e0 ... 1e10 as float
+static const double pow10_exact[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static const float pow10f_exact[] = {
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+};
+
+static inline double pow10_exact_of(int q, double*) { return pow10_exact[q]; }
+static inline float pow10_exact_of(int q, float*) { return pow10f_exact[q]; }
+
+// 5^q for q = -342 ... 308, normalized to 128 bits (high, low), truncated (q >= 0) or rounded up (q < 0)
+const int smallest_power_of_five = -342;
+static const uint64_t power_of_five_128[] = {
+    0xeef453d6923bd65a, 0x113faa2906a13b3f,
+    0x9558b4661b6565f8, 0x4ac7ca59a424c507,
+    0xbaaee17fa23ebf76, 0x5d79bcf00d2df649,
+    0xe95a99df8ace6f53, 0xf4d82c2c107973dc,
+    0x91d8a02bb6c10594, 0x79071b9b8a4be869,
+    0xb64ec836a47146f9, 0x9748e2826cdee284,
+    0xe3e27a444d8d98b7, 0xfd1b1b2308169b25,
+    0x8e6d8c6ab0787f72, 0xfe30f0f5e50e20f7,
+    0xb208ef855c969f4f, 0xbdbd2d335e51a935,
+    0xde8b2b66b3bc4723, 0xad2c788035e61382,
+    0x8b16fb203055ac76, 0x4c3bcb5021afcc31,
+    0xaddcb9e83c6b1793, 0xdf4abe242a1bbf3d,
+    0xd953e8624b85dd78, 0xd71d6dad34a2af0d,
+    0x87d4713d6f33aa6b, 0x8672648c40e5ad68,
+    0xa9c98d8ccb009506, 0x680efdaf511f18c2,
+    0xd43bf0effdc0ba48, 0x0212bd1b2566def2,
+    0x84a57695fe98746d, 0x014bb630f7604b57,
+    0xa5ced43b7e3e9188, 0x419ea3bd35385e2d,
+    0xcf42894a5dce35ea, 0x52064cac828675b9,
+    0x818995ce7aa0e1b2, 0x7343efebd1940993,
+    0xa1ebfb4219491a1f, 0x1014ebe6c5f90bf8,
+    0xca66fa129f9b60a6, 0xd41a26e077774ef6,
+    0xfd00b897478238d0, 0x8920b098955522b4,
+    0x9e20735e8cb16382, 0x55b46e5f5d5535b0,
+    0xc5a890362fddbc62, 0xeb2189f734aa831d,
+    0xf712b443bbd52b7b, 0xa5e9ec7501d523e4,
+    0x9a6bb0aa55653b2d, 0x47b233c92125366e,
+    0xc1069cd4eabe89f8, 0x999ec0bb696e840a,
+    0xf148440a256e2c76, 0xc00670ea43ca250d,
+    0x96cd2a865764dbca, 0x380406926a5e5728,
+    0xbc807527ed3e12bc, 0xc605083704f5ecf2,
+    0xeba09271e88d976b, 0xf7864a44c633682e,
+    0x93445b8731587ea3, 0x7ab3ee6afbe0211d,
+    0xb8157268fdae9e4c, 0x5960ea05bad82964,
+    0xe61acf033d1a45df, 0x6fb92487298e33bd,
+    0x8fd0c16206306bab, 0xa5d3b6d479f8e056,
+    0xb3c4f1ba87bc8696, 0x8f48a4899877186c,
+    0xe0b62e2929aba83c, 0x331acdabfe94de87,
+    0x8c71dcd9ba0b4925, 0x9ff0c08b7f1d0b14,
+    0xaf8e5410288e1b6f, 0x07ecf0ae5ee44dd9,
+    0xdb71e91432b1a24a, 0xc9e82cd9f69d6150,
+    0x892731ac9faf056e, 0xbe311c083a225cd2,
+    0xab70fe17c79ac6ca, 0x6dbd630a48aaf406,
+    0xd64d3d9db981787d, 0x092cbbccdad5b108,
+    0x85f0468293f0eb4e, 0x25bbf56008c58ea5,
+    0xa76c582338ed2621, 0xaf2af2b80af6f24e,
+    0xd1476e2c07286faa, 0x1af5af660db4aee1,
+    0x82cca4db847945ca, 0x50d98d9fc890ed4d,
+    0xa37fce126597973c, 0xe50ff107bab528a0,
+    0xcc5fc196fefd7d0c, 0x1e53ed49a96272c8,
+    0xff77b1fcbebcdc4f, 0x25e8e89c13bb0f7a,
+    0x9faacf3df73609b1, 0x77b191618c54e9ac,
+    0xc795830d75038c1d, 0xd59df5b9ef6a2417,
+    0xf97ae3d0d2446f25, 0x4b0573286b44ad1d,
+    0x9becce62836ac577, 0x4ee367f9430aec32,
+    0xc2e801fb244576d5, 0x229c41f793cda73f,
+    0xf3a20279ed56d48a, 0x6b43527578c1110f,
+    0x9845418c345644d6, 0x830a13896b78aaa9,
+    0xbe5691ef416bd60c, 0x23cc986bc656d553,
+    0xedec366b11c6cb8f, 0x2cbfbe86b7ec8aa8,
+    0x94b3a202eb1c3f39, 0x7bf7d71432f3d6a9,
+    0xb9e08a83a5e34f07, 0xdaf5ccd93fb0cc53,
+    0xe858ad248f5c22c9, 0xd1b3400f8f9cff68,
+    0x91376c36d99995be, 0x23100809b9c21fa1,
+    0xb58547448ffffb2d, 0xabd40a0c2832a78a,
+    0xe2e69915b3fff9f9, 0x16c90c8f323f516c,
+    0x8dd01fad907ffc3b, 0xae3da7d97f6792e3,
+    0xb1442798f49ffb4a, 0x99cd11cfdf41779c,
+    0xdd95317f31c7fa1d, 0x40405643d711d583,
+    0x8a7d3eef7f1cfc52, 0x482835ea666b2572,
+    0xad1c8eab5ee43b66, 0xda3243650005eecf,
+    0xd863b256369d4a40, 0x90bed43e40076a82,
+    0x873e4f75e2224e68, 0x5a7744a6e804a291,
+    0xa90de3535aaae202, 0x711515d0a205cb36,
+    0xd3515c2831559a83, 0x0d5a5b44ca873e03,
+    0x8412d9991ed58091, 0xe858790afe9486c2,
+    0xa5178fff668ae0b6, 0x626e974dbe39a872,
+    0xce5d73ff402d98e3, 0xfb0a3d212dc8128f,
+    0x80fa687f881c7f8e, 0x7ce66634bc9d0b99,
+    0xa139029f6a239f72, 0x1c1fffc1ebc44e80,
+    0xc987434744ac874e, 0xa327ffb266b56220,
+    0xfbe9141915d7a922, 0x4bf1ff9f0062baa8,
+    0x9d71ac8fada6c9b5, 0x6f773fc3603db4a9,
+    0xc4ce17b399107c22, 0xcb550fb4384d21d3,
+    0xf6019da07f549b2b, 0x7e2a53a146606a48,
+    0x99c102844f94e0fb, 0x2eda7444cbfc426d,
+    0xc0314325637a1939, 0xfa911155fefb5308,
+    0xf03d93eebc589f88, 0x793555ab7eba27ca,
+    0x96267c7535b763b5, 0x4bc1558b2f3458de,
+    0xbbb01b9283253ca2, 0x9eb1aaedfb016f16,
+    0xea9c227723ee8bcb, 0x465e15a979c1cadc,
+    0x92a1958a7675175f, 0x0bfacd89ec191ec9,
+    0xb749faed14125d36, 0xcef980ec671f667b,
+    0xe51c79a85916f484, 0x82b7e12780e7401a,
+    0x8f31cc0937ae58d2, 0xd1b2ecb8b0908810,
+    0xb2fe3f0b8599ef07, 0x861fa7e6dcb4aa15,
+    0xdfbdcece67006ac9, 0x67a791e093e1d49a,
+    0x8bd6a141006042bd, 0xe0c8bb2c5c6d24e0,
+    0xaecc49914078536d, 0x58fae9f773886e18,
+    0xda7f5bf590966848, 0xaf39a475506a899e,
+    0x888f99797a5e012d, 0x6d8406c952429603,
+    0xaab37fd7d8f58178, 0xc8e5087ba6d33b83,
+    0xd5605fcdcf32e1d6, 0xfb1e4a9a90880a64,
+    0x855c3be0a17fcd26, 0x5cf2eea09a55067f,
+    0xa6b34ad8c9dfc06f, 0xf42faa48c0ea481e,
+    0xd0601d8efc57b08b, 0xf13b94daf124da26,
+    0x823c12795db6ce57, 0x76c53d08d6b70858,
+    0xa2cb1717b52481ed, 0x54768c4b0c64ca6e,
+    0xcb7ddcdda26da268, 0xa9942f5dcf7dfd09,
+    0xfe5d54150b090b02, 0xd3f93b35435d7c4c,
+    0x9efa548d26e5a6e1, 0xc47bc5014a1a6daf,
+    0xc6b8e9b0709f109a, 0x359ab6419ca1091b,
+    0xf867241c8cc6d4c0, 0xc30163d203c94b62,
+    0x9b407691d7fc44f8, 0x79e0de63425dcf1d,
+    0xc21094364dfb5636, 0x985915fc12f542e4,
+    0xf294b943e17a2bc4, 0x3e6f5b7b17b2939d,
+    0x979cf3ca6cec5b5a, 0xa705992ceecf9c42,
+    0xbd8430bd08277231, 0x50c6ff782a838353,
+    0xece53cec4a314ebd, 0xa4f8bf5635246428,
+    0x940f4613ae5ed136, 0x871b7795e136be99,
+    0xb913179899f68584, 0x28e2557b59846e3f,
+    0xe757dd7ec07426e5, 0x331aeada2fe589cf,
+    0x9096ea6f3848984f, 0x3ff0d2c85def7621,
+    0xb4bca50b065abe63, 0x0fed077a756b53a9,
+    0xe1ebce4dc7f16dfb, 0xd3e8495912c62894,
+    0x8d3360f09cf6e4bd, 0x64712dd7abbbd95c,
+    0xb080392cc4349dec, 0xbd8d794d96aacfb3,
+    0xdca04777f541c567, 0xecf0d7a0fc5583a0,
+    0x89e42caaf9491b60, 0xf41686c49db57244,
+    0xac5d37d5b79b6239, 0x311c2875c522ced5,
+    0xd77485cb25823ac7, 0x7d633293366b828b,
+    0x86a8d39ef77164bc, 0xae5dff9c02033197,
+    0xa8530886b54dbdeb, 0xd9f57f830283fdfc,
+    0xd267caa862a12d66, 0xd072df63c324fd7b,
+    0x8380dea93da4bc60, 0x4247cb9e59f71e6d,
+    0xa46116538d0deb78, 0x52d9be85f074e608,
+    0xcd795be870516656, 0x67902e276c921f8b,
+    0x806bd9714632dff6, 0x00ba1cd8a3db53b6,
+    0xa086cfcd97bf97f3, 0x80e8a40eccd228a4,
+    0xc8a883c0fdaf7df0, 0x6122cd128006b2cd,
+    0xfad2a4b13d1b5d6c, 0x796b805720085f81,
+    0x9cc3a6eec6311a63, 0xcbe3303674053bb0,
+    0xc3f490aa77bd60fc, 0xbedbfc4411068a9c,
+    0xf4f1b4d515acb93b, 0xee92fb5515482d44,
+    0x991711052d8bf3c5, 0x751bdd152d4d1c4a,
+    0xbf5cd54678eef0b6, 0xd262d45a78a0635d,
+    0xef340a98172aace4, 0x86fb897116c87c34,
+    0x9580869f0e7aac0e, 0xd45d35e6ae3d4da0,
+    0xbae0a846d2195712, 0x8974836059cca109,
+    0xe998d258869facd7, 0x2bd1a438703fc94b,
+    0x91ff83775423cc06, 0x7b6306a34627ddcf,
+    0xb67f6455292cbf08, 0x1a3bc84c17b1d542,
+    0xe41f3d6a7377eeca, 0x20caba5f1d9e4a93,
+    0x8e938662882af53e, 0x547eb47b7282ee9c,
+    0xb23867fb2a35b28d, 0xe99e619a4f23aa43,
+    0xdec681f9f4c31f31, 0x6405fa00e2ec94d4,
+    0x8b3c113c38f9f37e, 0xde83bc408dd3dd04,
+    0xae0b158b4738705e, 0x9624ab50b148d445,
+    0xd98ddaee19068c76, 0x3badd624dd9b0957,
+    0x87f8a8d4cfa417c9, 0xe54ca5d70a80e5d6,
+    0xa9f6d30a038d1dbc, 0x5e9fcf4ccd211f4c,
+    0xd47487cc8470652b, 0x7647c3200069671f,
+    0x84c8d4dfd2c63f3b, 0x29ecd9f40041e073,
+    0xa5fb0a17c777cf09, 0xf468107100525890,
+    0xcf79cc9db955c2cc, 0x7182148d4066eeb4,
+    0x81ac1fe293d599bf, 0xc6f14cd848405530,
+    0xa21727db38cb002f, 0xb8ada00e5a506a7c,
+    0xca9cf1d206fdc03b, 0xa6d90811f0e4851c,
+    0xfd442e4688bd304a, 0x908f4a166d1da663,
+    0x9e4a9cec15763e2e, 0x9a598e4e043287fe,
+    0xc5dd44271ad3cdba, 0x40eff1e1853f29fd,
+    0xf7549530e188c128, 0xd12bee59e68ef47c,
+    0x9a94dd3e8cf578b9, 0x82bb74f8301958ce,
+    0xc13a148e3032d6e7, 0xe36a52363c1faf01,
+    0xf18899b1bc3f8ca1, 0xdc44e6c3cb279ac1,
+    0x96f5600f15a7b7e5, 0x29ab103a5ef8c0b9,
+    0xbcb2b812db11a5de, 0x7415d448f6b6f0e7,
+    0xebdf661791d60f56, 0x111b495b3464ad21,
+    0x936b9fcebb25c995, 0xcab10dd900beec34,
+    0xb84687c269ef3bfb, 0x3d5d514f40eea742,
+    0xe65829b3046b0afa, 0x0cb4a5a3112a5112,
+    0x8ff71a0fe2c2e6dc, 0x47f0e785eaba72ab,
+    0xb3f4e093db73a093, 0x59ed216765690f56,
+    0xe0f218b8d25088b8, 0x306869c13ec3532c,
+    0x8c974f7383725573, 0x1e414218c73a13fb,
+    0xafbd2350644eeacf, 0xe5d1929ef90898fa,
+    0xdbac6c247d62a583, 0xdf45f746b74abf39,
+    0x894bc396ce5da772, 0x6b8bba8c328eb783,
+    0xab9eb47c81f5114f, 0x066ea92f3f326564,
+    0xd686619ba27255a2, 0xc80a537b0efefebd,
+    0x8613fd0145877585, 0xbd06742ce95f5f36,
+    0xa798fc4196e952e7, 0x2c48113823b73704,
+    0xd17f3b51fca3a7a0, 0xf75a15862ca504c5,
+    0x82ef85133de648c4, 0x9a984d73dbe722fb,
+    0xa3ab66580d5fdaf5, 0xc13e60d0d2e0ebba,
+    0xcc963fee10b7d1b3, 0x318df905079926a8,
+    0xffbbcfe994e5c61f, 0xfdf17746497f7052,
+    0x9fd561f1fd0f9bd3, 0xfeb6ea8bedefa633,
+    0xc7caba6e7c5382c8, 0xfe64a52ee96b8fc0,
+    0xf9bd690a1b68637b, 0x3dfdce7aa3c673b0,
+    0x9c1661a651213e2d, 0x06bea10ca65c084e,
+    0xc31bfa0fe5698db8, 0x486e494fcff30a62,
+    0xf3e2f893dec3f126, 0x5a89dba3c3efccfa,
+    0x986ddb5c6b3a76b7, 0xf89629465a75e01c,
+    0xbe89523386091465, 0xf6bbb397f1135823,
+    0xee2ba6c0678b597f, 0x746aa07ded582e2c,
+    0x94db483840b717ef, 0xa8c2a44eb4571cdc,
+    0xba121a4650e4ddeb, 0x92f34d62616ce413,
+    0xe896a0d7e51e1566, 0x77b020baf9c81d17,
+    0x915e2486ef32cd60, 0x0ace1474dc1d122e,
+    0xb5b5ada8aaff80b8, 0x0d819992132456ba,
+    0xe3231912d5bf60e6, 0x10e1fff697ed6c69,
+    0x8df5efabc5979c8f, 0xca8d3ffa1ef463c1,
+    0xb1736b96b6fd83b3, 0xbd308ff8a6b17cb2,
+    0xddd0467c64bce4a0, 0xac7cb3f6d05ddbde,
+    0x8aa22c0dbef60ee4, 0x6bcdf07a423aa96b,
+    0xad4ab7112eb3929d, 0x86c16c98d2c953c6,
+    0xd89d64d57a607744, 0xe871c7bf077ba8b7,
+    0x87625f056c7c4a8b, 0x11471cd764ad4972,
+    0xa93af6c6c79b5d2d, 0xd598e40d3dd89bcf,
+    0xd389b47879823479, 0x4aff1d108d4ec2c3,
+    0x843610cb4bf160cb, 0xcedf722a585139ba,
+    0xa54394fe1eedb8fe, 0xc2974eb4ee658828,
+    0xce947a3da6a9273e, 0x733d226229feea32,
+    0x811ccc668829b887, 0x0806357d5a3f525f,
+    0xa163ff802a3426a8, 0xca07c2dcb0cf26f7,
+    0xc9bcff6034c13052, 0xfc89b393dd02f0b5,
+    0xfc2c3f3841f17c67, 0xbbac2078d443ace2,
+    0x9d9ba7832936edc0, 0xd54b944b84aa4c0d,
+    0xc5029163f384a931, 0x0a9e795e65d4df11,
+    0xf64335bcf065d37d, 0x4d4617b5ff4a16d5,
+    0x99ea0196163fa42e, 0x504bced1bf8e4e45,
+    0xc06481fb9bcf8d39, 0xe45ec2862f71e1d6,
+    0xf07da27a82c37088, 0x5d767327bb4e5a4c,
+    0x964e858c91ba2655, 0x3a6a07f8d510f86f,
+    0xbbe226efb628afea, 0x890489f70a55368b,
+    0xeadab0aba3b2dbe5, 0x2b45ac74ccea842e,
+    0x92c8ae6b464fc96f, 0x3b0b8bc90012929d,
+    0xb77ada0617e3bbcb, 0x09ce6ebb40173744,
+    0xe55990879ddcaabd, 0xcc420a6a101d0515,
+    0x8f57fa54c2a9eab6, 0x9fa946824a12232d,
+    0xb32df8e9f3546564, 0x47939822dc96abf9,
+    0xdff9772470297ebd, 0x59787e2b93bc56f7,
+    0x8bfbea76c619ef36, 0x57eb4edb3c55b65a,
+    0xaefae51477a06b03, 0xede622920b6b23f1,
+    0xdab99e59958885c4, 0xe95fab368e45eced,
+    0x88b402f7fd75539b, 0x11dbcb0218ebb414,
+    0xaae103b5fcd2a881, 0xd652bdc29f26a119,
+    0xd59944a37c0752a2, 0x4be76d3346f0495f,
+    0x857fcae62d8493a5, 0x6f70a4400c562ddb,
+    0xa6dfbd9fb8e5b88e, 0xcb4ccd500f6bb952,
+    0xd097ad07a71f26b2, 0x7e2000a41346a7a7,
+    0x825ecc24c873782f, 0x8ed400668c0c28c8,
+    0xa2f67f2dfa90563b, 0x728900802f0f32fa,
+    0xcbb41ef979346bca, 0x4f2b40a03ad2ffb9,
+    0xfea126b7d78186bc, 0xe2f610c84987bfa8,
+    0x9f24b832e6b0f436, 0x0dd9ca7d2df4d7c9,
+    0xc6ede63fa05d3143, 0x91503d1c79720dbb,
+    0xf8a95fcf88747d94, 0x75a44c6397ce912a,
+    0x9b69dbe1b548ce7c, 0xc986afbe3ee11aba,
+    0xc24452da229b021b, 0xfbe85badce996168,
+    0xf2d56790ab41c2a2, 0xfae27299423fb9c3,
+    0x97c560ba6b0919a5, 0xdccd879fc967d41a,
+    0xbdb6b8e905cb600f, 0x5400e987bbc1c920,
+    0xed246723473e3813, 0x290123e9aab23b68,
+    0x9436c0760c86e30b, 0xf9a0b6720aaf6521,
+    0xb94470938fa89bce, 0xf808e40e8d5b3e69,
+    0xe7958cb87392c2c2, 0xb60b1d1230b20e04,
+    0x90bd77f3483bb9b9, 0xb1c6f22b5e6f48c2,
+    0xb4ecd5f01a4aa828, 0x1e38aeb6360b1af3,
+    0xe2280b6c20dd5232, 0x25c6da63c38de1b0,
+    0x8d590723948a535f, 0x579c487e5a38ad0e,
+    0xb0af48ec79ace837, 0x2d835a9df0c6d851,
+    0xdcdb1b2798182244, 0xf8e431456cf88e65,
+    0x8a08f0f8bf0f156b, 0x1b8e9ecb641b58ff,
+    0xac8b2d36eed2dac5, 0xe272467e3d222f3f,
+    0xd7adf884aa879177, 0x5b0ed81dcc6abb0f,
+    0x86ccbb52ea94baea, 0x98e947129fc2b4e9,
+    0xa87fea27a539e9a5, 0x3f2398d747b36224,
+    0xd29fe4b18e88640e, 0x8eec7f0d19a03aad,
+    0x83a3eeeef9153e89, 0x1953cf68300424ac,
+    0xa48ceaaab75a8e2b, 0x5fa8c3423c052dd7,
+    0xcdb02555653131b6, 0x3792f412cb06794d,
+    0x808e17555f3ebf11, 0xe2bbd88bbee40bd0,
+    0xa0b19d2ab70e6ed6, 0x5b6aceaeae9d0ec4,
+    0xc8de047564d20a8b, 0xf245825a5a445275,
+    0xfb158592be068d2e, 0xeed6e2f0f0d56712,
+    0x9ced737bb6c4183d, 0x55464dd69685606b,
+    0xc428d05aa4751e4c, 0xaa97e14c3c26b886,
+    0xf53304714d9265df, 0xd53dd99f4b3066a8,
+    0x993fe2c6d07b7fab, 0xe546a8038efe4029,
+    0xbf8fdb78849a5f96, 0xde98520472bdd033,
+    0xef73d256a5c0f77c, 0x963e66858f6d4440,
+    0x95a8637627989aad, 0xdde7001379a44aa8,
+    0xbb127c53b17ec159, 0x5560c018580d5d52,
+    0xe9d71b689dde71af, 0xaab8f01e6e10b4a6,
+    0x9226712162ab070d, 0xcab3961304ca70e8,
+    0xb6b00d69bb55c8d1, 0x3d607b97c5fd0d22,
+    0xe45c10c42a2b3b05, 0x8cb89a7db77c506a,
+    0x8eb98a7a9a5b04e3, 0x77f3608e92adb242,
+    0xb267ed1940f1c61c, 0x55f038b237591ed3,
+    0xdf01e85f912e37a3, 0x6b6c46dec52f6688,
+    0x8b61313bbabce2c6, 0x2323ac4b3b3da015,
+    0xae397d8aa96c1b77, 0xabec975e0a0d081a,
+    0xd9c7dced53c72255, 0x96e7bd358c904a21,
+    0x881cea14545c7575, 0x7e50d64177da2e54,
+    0xaa242499697392d2, 0xdde50bd1d5d0b9e9,
+    0xd4ad2dbfc3d07787, 0x955e4ec64b44e864,
+    0x84ec3c97da624ab4, 0xbd5af13bef0b113e,
+    0xa6274bbdd0fadd61, 0xecb1ad8aeacdd58e,
+    0xcfb11ead453994ba, 0x67de18eda5814af2,
+    0x81ceb32c4b43fcf4, 0x80eacf948770ced7,
+    0xa2425ff75e14fc31, 0xa1258379a94d028d,
+    0xcad2f7f5359a3b3e, 0x096ee45813a04330,
+    0xfd87b5f28300ca0d, 0x8bca9d6e188853fc,
+    0x9e74d1b791e07e48, 0x775ea264cf55347e,
+    0xc612062576589dda, 0x95364afe032a819e,
+    0xf79687aed3eec551, 0x3a83ddbd83f52205,
+    0x9abe14cd44753b52, 0xc4926a9672793543,
+    0xc16d9a0095928a27, 0x75b7053c0f178294,
+    0xf1c90080baf72cb1, 0x5324c68b12dd6339,
+    0x971da05074da7bee, 0xd3f6fc16ebca5e04,
+    0xbce5086492111aea, 0x88f4bb1ca6bcf585,
+    0xec1e4a7db69561a5, 0x2b31e9e3d06c32e6,
+    0x9392ee8e921d5d07, 0x3aff322e62439fd0,
+    0xb877aa3236a4b449, 0x09befeb9fad487c3,
+    0xe69594bec44de15b, 0x4c2ebe687989a9b4,
+    0x901d7cf73ab0acd9, 0x0f9d37014bf60a11,
+    0xb424dc35095cd80f, 0x538484c19ef38c95,
+    0xe12e13424bb40e13, 0x2865a5f206b06fba,
+    0x8cbccc096f5088cb, 0xf93f87b7442e45d4,
+    0xafebff0bcb24aafe, 0xf78f69a51539d749,
+    0xdbe6fecebdedd5be, 0xb573440e5a884d1c,
+    0x89705f4136b4a597, 0x31680a88f8953031,
+    0xabcc77118461cefc, 0xfdc20d2b36ba7c3e,
+    0xd6bf94d5e57a42bc, 0x3d32907604691b4d,
+    0x8637bd05af6c69b5, 0xa63f9a49c2c1b110,
+    0xa7c5ac471b478423, 0x0fcf80dc33721d54,
+    0xd1b71758e219652b, 0xd3c36113404ea4a9,
+    0x83126e978d4fdf3b, 0x645a1cac083126ea,
+    0xa3d70a3d70a3d70a, 0x3d70a3d70a3d70a4,
+    0xcccccccccccccccc, 0xcccccccccccccccd,
+    0x8000000000000000, 0x0000000000000000,
+    0xa000000000000000, 0x0000000000000000,
+    0xc800000000000000, 0x0000000000000000,
+    0xfa00000000000000, 0x0000000000000000,
+    0x9c40000000000000, 0x0000000000000000,
+    0xc350000000000000, 0x0000000000000000,
+    0xf424000000000000, 0x0000000000000000,
+    0x9896800000000000, 0x0000000000000000,
+    0xbebc200000000000, 0x0000000000000000,
+    0xee6b280000000000, 0x0000000000000000,
+    0x9502f90000000000, 0x0000000000000000,
+    0xba43b74000000000, 0x0000000000000000,
+    0xe8d4a51000000000, 0x0000000000000000,
+    0x9184e72a00000000, 0x0000000000000000,
+    0xb5e620f480000000, 0x0000000000000000,
+    0xe35fa931a0000000, 0x0000000000000000,
+    0x8e1bc9bf04000000, 0x0000000000000000,
+    0xb1a2bc2ec5000000, 0x0000000000000000,
+    0xde0b6b3a76400000, 0x0000000000000000,
+    0x8ac7230489e80000, 0x0000000000000000,
+    0xad78ebc5ac620000, 0x0000000000000000,
+    0xd8d726b7177a8000, 0x0000000000000000,
+    0x878678326eac9000, 0x0000000000000000,
+    0xa968163f0a57b400, 0x0000000000000000,
+    0xd3c21bcecceda100, 0x0000000000000000,
+    0x84595161401484a0, 0x0000000000000000,
+    0xa56fa5b99019a5c8, 0x0000000000000000,
+    0xcecb8f27f4200f3a, 0x0000000000000000,
+    0x813f3978f8940984, 0x4000000000000000,
+    0xa18f07d736b90be5, 0x5000000000000000,
+    0xc9f2c9cd04674ede, 0xa400000000000000,
+    0xfc6f7c4045812296, 0x4d00000000000000,
+    0x9dc5ada82b70b59d, 0xf020000000000000,
+    0xc5371912364ce305, 0x6c28000000000000,
+    0xf684df56c3e01bc6, 0xc732000000000000,
+    0x9a130b963a6c115c, 0x3c7f400000000000,
+    0xc097ce7bc90715b3, 0x4b9f100000000000,
+    0xf0bdc21abb48db20, 0x1e86d40000000000,
+    0x96769950b50d88f4, 0x1314448000000000,
+    0xbc143fa4e250eb31, 0x17d955a000000000,
+    0xeb194f8e1ae525fd, 0x5dcfab0800000000,
+    0x92efd1b8d0cf37be, 0x5aa1cae500000000,
+    0xb7abc627050305ad, 0xf14a3d9e40000000,
+    0xe596b7b0c643c719, 0x6d9ccd05d0000000,
+    0x8f7e32ce7bea5c6f, 0xe4820023a2000000,
+    0xb35dbf821ae4f38b, 0xdda2802c8a800000,
+    0xe0352f62a19e306e, 0xd50b2037ad200000,
+    0x8c213d9da502de45, 0x4526f422cc340000,
+    0xaf298d050e4395d6, 0x9670b12b7f410000,
+    0xdaf3f04651d47b4c, 0x3c0cdd765f114000,
+    0x88d8762bf324cd0f, 0xa5880a69fb6ac800,
+    0xab0e93b6efee0053, 0x8eea0d047a457a00,
+    0xd5d238a4abe98068, 0x72a4904598d6d880,
+    0x85a36366eb71f041, 0x47a6da2b7f864750,
+    0xa70c3c40a64e6c51, 0x999090b65f67d924,
+    0xd0cf4b50cfe20765, 0xfff4b4e3f741cf6d,
+    0x82818f1281ed449f, 0xbff8f10e7a8921a4,
+    0xa321f2d7226895c7, 0xaff72d52192b6a0d,
+    0xcbea6f8ceb02bb39, 0x9bf4f8a69f764490,
+    0xfee50b7025c36a08, 0x02f236d04753d5b4,
+    0x9f4f2726179a2245, 0x01d762422c946590,
+    0xc722f0ef9d80aad6, 0x424d3ad2b7b97ef5,
+    0xf8ebad2b84e0d58b, 0xd2e0898765a7deb2,
+    0x9b934c3b330c8577, 0x63cc55f49f88eb2f,
+    0xc2781f49ffcfa6d5, 0x3cbf6b71c76b25fb,
+    0xf316271c7fc3908a, 0x8bef464e3945ef7a,
+    0x97edd871cfda3a56, 0x97758bf0e3cbb5ac,
+    0xbde94e8e43d0c8ec, 0x3d52eeed1cbea317,
+    0xed63a231d4c4fb27, 0x4ca7aaa863ee4bdd,
+    0x945e455f24fb1cf8, 0x8fe8caa93e74ef6a,
+    0xb975d6b6ee39e436, 0xb3e2fd538e122b44,
+    0xe7d34c64a9c85d44, 0x60dbbca87196b616,
+    0x90e40fbeea1d3a4a, 0xbc8955e946fe31cd,
+    0xb51d13aea4a488dd, 0x6babab6398bdbe41,
+    0xe264589a4dcdab14, 0xc696963c7eed2dd1,
+    0x8d7eb76070a08aec, 0xfc1e1de5cf543ca2,
+    0xb0de65388cc8ada8, 0x3b25a55f43294bcb,
+    0xdd15fe86affad912, 0x49ef0eb713f39ebe,
+    0x8a2dbf142dfcc7ab, 0x6e3569326c784337,
+    0xacb92ed9397bf996, 0x49c2c37f07965404,
+    0xd7e77a8f87daf7fb, 0xdc33745ec97be906,
+    0x86f0ac99b4e8dafd, 0x69a028bb3ded71a3,
+    0xa8acd7c0222311bc, 0xc40832ea0d68ce0c,
+    0xd2d80db02aabd62b, 0xf50a3fa490c30190,
+    0x83c7088e1aab65db, 0x792667c6da79e0fa,
+    0xa4b8cab1a1563f52, 0x577001b891185938,
+    0xcde6fd5e09abcf26, 0xed4c0226b55e6f86,
+    0x80b05e5ac60b6178, 0x544f8158315b05b4,
+    0xa0dc75f1778e39d6, 0x696361ae3db1c721,
+    0xc913936dd571c84c, 0x03bc3a19cd1e38e9,
+    0xfb5878494ace3a5f, 0x04ab48a04065c723,
+    0x9d174b2dcec0e47b, 0x62eb0d64283f9c76,
+    0xc45d1df942711d9a, 0x3ba5d0bd324f8394,
+    0xf5746577930d6500, 0xca8f44ec7ee36479,
+    0x9968bf6abbe85f20, 0x7e998b13cf4e1ecb,
+    0xbfc2ef456ae276e8, 0x9e3fedd8c321a67e,
+    0xefb3ab16c59b14a2, 0xc5cfe94ef3ea101e,
+    0x95d04aee3b80ece5, 0xbba1f1d158724a12,
+    0xbb445da9ca61281f, 0x2a8a6e45ae8edc97,
+    0xea1575143cf97226, 0xf52d09d71a3293bd,
+    0x924d692ca61be758, 0x593c2626705f9c56,
+    0xb6e0c377cfa2e12e, 0x6f8b2fb00c77836c,
+    0xe498f455c38b997a, 0x0b6dfb9c0f956447,
+    0x8edf98b59a373fec, 0x4724bd4189bd5eac,
+    0xb2977ee300c50fe7, 0x58edec91ec2cb657,
+    0xdf3d5e9bc0f653e1, 0x2f2967b66737e3ed,
+    0x8b865b215899f46c, 0xbd79e0d20082ee74,
+    0xae67f1e9aec07187, 0xecd8590680a3aa11,
+    0xda01ee641a708de9, 0xe80e6f4820cc9495,
+    0x884134fe908658b2, 0x3109058d147fdcdd,
+    0xaa51823e34a7eede, 0xbd4b46f0599fd415,
+    0xd4e5e2cdc1d1ea96, 0x6c9e18ac7007c91a,
+    0x850fadc09923329e, 0x03e2cf6bc604ddb0,
+    0xa6539930bf6bff45, 0x84db8346b786151c,
+    0xcfe87f7cef46ff16, 0xe612641865679a63,
+    0x81f14fae158c5f6e, 0x4fcb7e8f3f60c07e,
+    0xa26da3999aef7749, 0xe3be5e330f38f09d,
+    0xcb090c8001ab551c, 0x5cadf5bfd3072cc5,
+    0xfdcb4fa002162a63, 0x73d9732fc7c8f7f6,
+    0x9e9f11c4014dda7e, 0x2867e7fddcdd9afa,
+    0xc646d63501a1511d, 0xb281e1fd541501b8,
+    0xf7d88bc24209a565, 0x1f225a7ca91a4226,
+    0x9ae757596946075f, 0x3375788de9b06958,
+    0xc1a12d2fc3978937, 0x0052d6b1641c83ae,
+    0xf209787bb47d6b84, 0xc0678c5dbd23a49a,
+    0x9745eb4d50ce6332, 0xf840b7ba963646e0,
+    0xbd176620a501fbff, 0xb650e5a93bc3d898,
+    0xec5d3fa8ce427aff, 0xa3e51f138ab4cebe,
+    0x93ba47c980e98cdf, 0xc66f336c36b10137,
+    0xb8a8d9bbe123f017, 0xb80b0047445d4184,
+    0xe6d3102ad96cec1d, 0xa60dc059157491e5,
+    0x9043ea1ac7e41392, 0x87c89837ad68db2f,
+    0xb454e4a179dd1877, 0x29babe4598c311fb,
+    0xe16a1dc9d8545e94, 0xf4296dd6fef3d67a,
+    0x8ce2529e2734bb1d, 0x1899e4a65f58660c,
+    0xb01ae745b101e9e4, 0x5ec05dcff72e7f8f,
+    0xdc21a1171d42645d, 0x76707543f4fa1f73,
+    0x899504ae72497eba, 0x6a06494a791c53a8,
+    0xabfa45da0edbde69, 0x0487db9d17636892,
+    0xd6f8d7509292d603, 0x45a9d2845d3c42b6,
+    0x865b86925b9bc5c2, 0x0b8a2392ba45a9b2,
+    0xa7f26836f282b732, 0x8e6cac7768d7141e,
+    0xd1ef0244af2364ff, 0x3207d795430cd926,
+    0x8335616aed761f1f, 0x7f44e6bd49e807b8,
+    0xa402b9c5a8d3a6e7, 0x5f16206c9c6209a6,
+    0xcd036837130890a1, 0x36dba887c37a8c0f,
+    0x802221226be55a64, 0xc2494954da2c9789,
+    0xa02aa96b06deb0fd, 0xf2db9baa10b7bd6c,
+    0xc83553c5c8965d3d, 0x6f92829494e5acc7,
+    0xfa42a8b73abbf48c, 0xcb772339ba1f17f9,
+    0x9c69a97284b578d7, 0xff2a760414536efb,
+    0xc38413cf25e2d70d, 0xfef5138519684aba,
+    0xf46518c2ef5b8cd1, 0x7eb258665fc25d69,
+    0x98bf2f79d5993802, 0xef2f773ffbd97a61,
+    0xbeeefb584aff8603, 0xaafb550ffacfd8fa,
+    0xeeaaba2e5dbf6784, 0x95ba2a53f983cf38,
+    0x952ab45cfa97a0b2, 0xdd945a747bf26183,
+    0xba756174393d88df, 0x94f971119aeef9e4,
+    0xe912b9d1478ceb17, 0x7a37cd5601aab85d,
+    0x91abb422ccb812ee, 0xac62e055c10ab33a,
+    0xb616a12b7fe617aa, 0x577b986b314d6009,
+    0xe39c49765fdf9d94, 0xed5a7e85fda0b80b,
+    0x8e41ade9fbebc27d, 0x14588f13be847307,
+    0xb1d219647ae6b31c, 0x596eb2d8ae258fc8,
+    0xde469fbd99a05fe3, 0x6fca5f8ed9aef3bb,
+    0x8aec23d680043bee, 0x25de7bb9480d5854,
+    0xada72ccc20054ae9, 0xaf561aa79a10ae6a,
+    0xd910f7ff28069da4, 0x1b2ba1518094da04,
+    0x87aa9aff79042286, 0x90fb44d2f05d0842,
+    0xa99541bf57452b28, 0x353a1607ac744a53,
+    0xd3fa922f2d1675f2, 0x42889b8997915ce8,
+    0x847c9b5d7c2e09b7, 0x69956135febada11,
+    0xa59bc234db398c25, 0x43fab9837e699095,
+    0xcf02b2c21207ef2e, 0x94f967e45e03f4bb,
+    0x8161afb94b44f57d, 0x1d1be0eebac278f5,
+    0xa1ba1ba79e1632dc, 0x6462d92a69731732,
+    0xca28a291859bbf93, 0x7d7b8f7503cfdcfe,
+    0xfcb2cb35e702af78, 0x5cda735244c3d43e,
+    0x9defbf01b061adab, 0x3a0888136afa64a7,
+    0xc56baec21c7a1916, 0x088aaa1845b8fdd0,
+    0xf6c69a72a3989f5b, 0x8aad549e57273d45,
+    0x9a3c2087a63f6399, 0x36ac54e2f678864b,
+    0xc0cb28a98fcf3c7f, 0x84576a1bb416a7dd,
+    0xf0fdf2d3f3c30b9f, 0x656d44a2a11c51d5,
+    0x969eb7c47859e743, 0x9f644ae5a4b1b325,
+    0xbc4665b596706114, 0x873d5d9f0dde1fee,
+    0xeb57ff22fc0c7959, 0xa90cb506d155a7ea,
+    0x9316ff75dd87cbd8, 0x09a7f12442d588f2,
+    0xb7dcbf5354e9bece, 0x0c11ed6d538aeb2f,
+    0xe5d3ef282a242e81, 0x8f1668c8a86da5fa,
+    0x8fa475791a569d10, 0xf96e017d694487bc,
+    0xb38d92d760ec4455, 0x37c981dcc395a9ac,
+    0xe070f78d3927556a, 0x85bbe253f47b1417,
+    0x8c469ab843b89562, 0x93956d7478ccec8e,
+    0xaf58416654a6babb, 0x387ac8d1970027b2,
+    0xdb2e51bfe9d0696a, 0x06997b05fcc0319e,
+    0x88fcf317f22241e2, 0x441fece3bdf81f03,
+    0xab3c2fddeeaad25a, 0xd527e81cad7626c3,
+    0xd60b3bd56a5586f1, 0x8a71e223d8d3b074,
+    0x85c7056562757456, 0xf6872d5667844e49,
+    0xa738c6bebb12d16c, 0xb428f8ac016561db,
+    0xd106f86e69d785c7, 0xe13336d701beba52,
+    0x82a45b450226b39c, 0xecc0024661173473,
+    0xa34d721642b06084, 0x27f002d7f95d0190,
+    0xcc20ce9bd35c78a5, 0x31ec038df7b441f4,
+    0xff290242c83396ce, 0x7e67047175a15271,
+    0x9f79a169bd203e41, 0x0f0062c6e984d386,
+    0xc75809c42c684dd1, 0x52c07b78a3e60868,
+    0xf92e0c3537826145, 0xa7709a56ccdf8a82,
+    0x9bbcc7a142b17ccb, 0x88a66076400bb691,
+    0xc2abf989935ddbfe, 0x6acff893d00ea435,
+    0xf356f7ebf83552fe, 0x0583f6b8c4124d43,
+    0x98165af37b2153de, 0xc3727a337a8b704a,
+    0xbe1bf1b059e9a8d6, 0x744f18c0592e4c5c,
+    0xeda2ee1c7064130c, 0x1162def06f79df73,
+    0x9485d4d1c63e8be7, 0x8addcb5645ac2ba8,
+    0xb9a74a0637ce2ee1, 0x6d953e2bd7173692,
+    0xe8111c87c5c1ba99, 0xc8fa8db6ccdd0437,
+    0x910ab1d4db9914a0, 0x1d9c9892400a22a2,
+    0xb54d5e4a127f59c8, 0x2503beb6d00cab4b,
+    0xe2a0b5dc971f303a, 0x2e44ae64840fd61d,
+    0x8da471a9de737e24, 0x5ceaecfed289e5d2,
+    0xb10d8e1456105dad, 0x7425a83e872c5f47,
+    0xdd50f1996b947518, 0xd12f124e28f77719,
+    0x8a5296ffe33cc92f, 0x82bd6b70d99aaa6f,
+    0xace73cbfdc0bfb7b, 0x636cc64d1001550b,
+    0xd8210befd30efa5a, 0x3c47f7e05401aa4e,
+    0x8714a775e3e95c78, 0x65acfaec34810a71,
+    0xa8d9d1535ce3b396, 0x7f1839a741a14d0d,
+    0xd31045a8341ca07c, 0x1ede48111209a050,
+    0x83ea2b892091e44d, 0x934aed0aab460432,
+    0xa4e4b66b68b65d60, 0xf81da84d5617853f,
+    0xce1de40642e3f4b9, 0x36251260ab9d668e,
+    0x80d2ae83e9ce78f3, 0xc1d72b7c6b426019,
+    0xa1075a24e4421730, 0xb24cf65b8612f81f,
+    0xc94930ae1d529cfc, 0xdee033f26797b627,
+    0xfb9b7cd9a4a7443c, 0x169840ef017da3b1,
+    0x9d412e0806e88aa5, 0x8e1f289560ee864e,
+    0xc491798a08a2ad4e, 0xf1a6f2bab92a27e2,
+    0xf5b5d7ec8acb58a2, 0xae10af696774b1db,
+    0x9991a6f3d6bf1765, 0xacca6da1e0a8ef29,
+    0xbff610b0cc6edd3f, 0x17fd090a58d32af3,
+    0xeff394dcff8a948e, 0xddfc4b4cef07f5b0,
+    0x95f83d0a1fb69cd9, 0x4abdaf101564f98e,
+    0xbb764c4ca7a4440f, 0x9d6d1ad41abe37f1,
+    0xea53df5fd18d5513, 0x84c86189216dc5ed,
+    0x92746b9be2f8552c, 0x32fd3cf5b4e49bb4,
+    0xb7118682dbb66a77, 0x3fbc8c33221dc2a1,
+    0xe4d5e82392a40515, 0x0fabaf3feaa5334a,
+    0x8f05b1163ba6832d, 0x29cb4d87f2a7400e,
+    0xb2c71d5bca9023f8, 0x743e20e9ef511012,
+    0xdf78e4b2bd342cf6, 0x914da9246b255416,
+    0x8bab8eefb6409c1a, 0x1ad089b6c2f7548e,
+    0xae9672aba3d0c320, 0xa184ac2473b529b1,
+    0xda3c0f568cc4f3e8, 0xc9e5d72d90a2741e,
+    0x8865899617fb1871, 0x7e2fa67c7a658892,
+    0xaa7eebfb9df9de8d, 0xddbb901b98feeab7,
+    0xd51ea6fa85785631, 0x552a74227f3ea565,
+    0x8533285c936b35de, 0xd53a88958f87275f,
+    0xa67ff273b8460356, 0x8a892abaf368f137,
+    0xd01fef10a657842c, 0x2d2b7569b0432d85,
+    0x8213f56a67f6b29b, 0x9c3b29620e29fc73,
+    0xa298f2c501f45f42, 0x8349f3ba91b47b8f,
+    0xcb3f2f7642717713, 0x241c70a936219a73,
+    0xfe0efb53d30dd4d7, 0xed238cd383aa0110,
+    0x9ec95d1463e8a506, 0xf4363804324a40aa,
+    0xc67bb4597ce2ce48, 0xb143c6053edcd0d5,
+    0xf81aa16fdc1b81da, 0xdd94b7868e94050a,
+    0x9b10a4e5e9913128, 0xca7cf2b4191c8326,
+    0xc1d4ce1f63f57d72, 0xfd1c2f611f63a3f0,
+    0xf24a01a73cf2dccf, 0xbc633b39673c8cec,
+    0x976e41088617ca01, 0xd5be0503e085d813,
+    0xbd49d14aa79dbc82, 0x4b2d8644d8a74e18,
+    0xec9c459d51852ba2, 0xddf8e7d60ed1219e,
+    0x93e1ab8252f33b45, 0xcabb90e5c942b503,
+    0xb8da1662e7b00a17, 0x3d6a751f3b936243,
+    0xe7109bfba19c0c9d, 0x0cc512670a783ad4,
+    0x906a617d450187e2, 0x27fb2b80668b24c5,
+    0xb484f9dc9641e9da, 0xb1f9f660802dedf6,
+    0xe1a63853bbd26451, 0x5e7873f8a0396973,
+    0x8d07e33455637eb2, 0xdb0b487b6423e1e8,
+    0xb049dc016abc5e5f, 0x91ce1a9a3d2cda62,
+    0xdc5c5301c56b75f7, 0x7641a140cc7810fb,
+    0x89b9b3e11b6329ba, 0xa9e904c87fcb0a9d,
+    0xac2820d9623bf429, 0x546345fa9fbdcd44,
+    0xd732290fbacaf133, 0xa97c177947ad4095,
+    0x867f59a9d4bed6c0, 0x49ed8eabcccc485d,
+    0xa81f301449ee8c70, 0x5c68f256bfff5a74,
+    0xd226fc195c6a2f8c, 0x73832eec6fff3111,
+    0x83585d8fd9c25db7, 0xc831fd53c5ff7eab,
+    0xa42e74f3d032f525, 0xba3e7ca8b77f5e55,
+    0xcd3a1230c43fb26f, 0x28ce1bd2e55f35eb,
+    0x80444b5e7aa7cf85, 0x7980d163cf5b81b3,
+    0xa0555e361951c366, 0xd7e105bcc332621f,
+    0xc86ab5c39fa63440, 0x8dd9472bf3fefaa7,
+    0xfa856334878fc150, 0xb14f98f6f0feb951,
+    0x9c935e00d4b9d8d2, 0x6ed1bf9a569f33d3,
+    0xc3b8358109e84f07, 0x0a862f80ec4700c8,
+    0xf4a642e14c6262c8, 0xcd27bb612758c0fa,
+    0x98e7e9cccfbd7dbd, 0x8038d51cb897789c,
+    0xbf21e44003acdd2c, 0xe0470a63e6bd56c3,
+    0xeeea5d5004981478, 0x1858ccfce06cac74,
+    0x95527a5202df0ccb, 0x0f37801e0c43ebc8,
+    0xbaa718e68396cffd, 0xd30560258f54e6ba,
+    0xe950df20247c83fd, 0x47c6b82ef32a2069,
+    0x91d28b7416cdd27e, 0x4cdc331d57fa5441,
+    0xb6472e511c81471d, 0xe0133fe4adf8e952,
+    0xe3d8f9e563a198e5, 0x58180fddd97723a6,
+    0x8e679c2f5e44ff8f, 0x570f09eaa7ea7648,
+};
+
+// the binary significand (without hidden bit) and biased exponent of a float
+struct adjusted_mantissa {
+    uint64_t mantissa;
+    int power2;
+};
+
+template<typename T>
+static adjusted_mantissa compute_float(int64_t q, uint64_t w) {
+    typedef binary_format<T> F;
+    adjusted_mantissa answer = {0, 0};
+    if (w == 0 || q < F::smallest_power_of_ten) return answer;
+    if (q > F::largest_power_of_ten) {
+        answer.power2 = F::infinite_power;
+        return answer;
+    }
+
+    const int lz = (int)clz64(w);
+    w <<= lz;
+
+    // w * 5^q, the upper mantissa_bits + 3 bits of which are exact (Mushtak, Lemire, "Fast Number Parsing Without Fallback")
+    const int index = 2 * (int)(q - smallest_power_of_five);
+    uint64_t high;
+    uint64_t low = mul128(w, power_of_five_128[index], &high);
+    const uint64_t precision_mask = ~0ull >> (F::mantissa_bits + 3);
+    if ((high & precision_mask) == precision_mask) {
+        uint64_t second_high;
+        mul128(w, power_of_five_128[index + 1], &second_high);
+        low += second_high;
+        if (second_high > low) high++;
+    }
+
+    const int upperbit = (int)(high >> 63);
+    const int shift = upperbit + 64 - F::mantissa_bits - 3;
+    answer.mantissa = high >> shift;
+    // floor(log2(10^q)) + 63 is (((152170 + 65536) * q) >> 16) + 63
+    answer.power2 = (int)((((152170 + 65536) * q) >> 16) + 63 + upperbit - lz - F::minimum_exponent);
+
+    if (answer.power2 <= 0) { // subnormal
+        if (-answer.power2 + 1 >= 64) {
+            answer.mantissa = 0;
+            answer.power2 = 0;
+            return answer;
+        }
+        answer.mantissa >>= -answer.power2 + 1;
+        answer.mantissa += answer.mantissa & 1; // round
+        answer.mantissa >>= 1;
+        // rounding may have made it normal
+        answer.power2 = answer.mantissa < (1ull << F::mantissa_bits) ? 0 : 1;
+        return answer;
+    }
+
+    // exactly halfway between two floats (only possible when 5^q fits in 64 bits): round to even
+    if (low <= 1 && q >= F::min_exponent_round_to_even && q <= F::max_exponent_round_to_even &&
+        (answer.mantissa & 3) == 1 && (answer.mantissa << shift) == high) {
+        answer.mantissa &= ~1ull;
+    }
+
+    answer.mantissa += answer.mantissa & 1; // round
+    answer.mantissa >>= 1;
+    if (answer.mantissa >= (2ull << F::mantissa_bits)) {
+        answer.mantissa = 1ull << F::mantissa_bits;
+        answer.power2++;
+    }
+    answer.mantissa &= ~(1ull << F::mantissa_bits);
+    if (answer.power2 >= F::infinite_power) {
+        answer.power2 = F::infinite_power;
+        answer.mantissa = 0;
+    }
+    return answer;
+}
+
+// strtod/strtof in the "C" locale, whatever the locale of the program, so that the decimal point is always '.'
+#ifdef _WIN32
+static _locale_t c_locale() {
+    static const _locale_t c = _create_locale(LC_ALL, "C");
+    return c;
+}
+static inline double strto_libc(const char* s, double*) { return _strtod_l(s, 0, c_locale()); }
+static inline float strto_libc(const char* s, float*) { return _strtof_l(s, 0, c_locale()); }
+#else
+static locale_t c_locale() {
+    static const locale_t c = newlocale(LC_ALL_MASK, "C", (locale_t)0);
+    return c;
+}
+static inline double strto_libc(const char* s, double*) { return strtod_l(s, 0, c_locale()); }
+static inline float strto_libc(const char* s, float*) { return strtof_l(s, 0, c_locale()); }
+#endif
+
+// strto_libc of [begin, end), which need not be 0 terminated. Only very long numbers are copied to the heap.
+template<typename T>
+static T strto_libc(const char* begin, const char* end) {
+    char buffer[256];
+    if ((size_t)(end - begin) < sizeof(buffer)) {
+        memcpy(buffer, begin, end - begin);
+        buffer[end - begin] = 0;
+        return strto_libc(buffer, (T*)0);
+    }
+    return strto_libc(std::string(begin, end).c_str(), (T*)0);
+}
+
+/*
+converts d, which was parsed from [begin, end), correctly rounded
+falls back to the C library for the rare cases where the digits beyond the first 19 matter
+*/
+template<typename T>
+static T decimal_to_float(const decimal_number& d, const char* begin, const char* end) {
+    typedef binary_format<T> F;
+    T x;
+    if (!d.truncated && d.q >= -F::max_exponent_fast_path && d.q <= F::max_exponent_fast_path && d.w <= F::max_mantissa_fast_path) {
+        x = (T)d.w;
+        x = d.q < 0 ? x / pow10_exact_of((int)-d.q, (T*)0) : x * pow10_exact_of((int)d.q, (T*)0);
+        return d.negative ? -x : x;
+    }
+
+    const adjusted_mantissa a = compute_float<T>(d.q, d.w);
+    if (d.truncated) {
+        const adjusted_mantissa b = compute_float<T>(d.q, d.w + 1);
+        if (a.mantissa != b.mantissa || a.power2 != b.power2) return strto_libc<T>(begin, end);
+    }
+
+    const typename F::bits bits = (typename F::bits)(a.mantissa | (uint64_t)a.power2 << F::mantissa_bits | (uint64_t)d.negative << (sizeof(T) * 8 - 1));
+    memcpy(&x, &bits, sizeof(T));
+    return x;
+}
+
+// *p, or 0 at end if bounded
+template<bool bounded>
+static inline char peek(const char* p, const char* end) {
+    return bounded && p >= end ? 0 : *p;
+}
+
+// SWAR digit parsing: 8 characters at a time in a 64 bit register, the first one in the lowest byte
+
+// loads the 8 bytes at p if they are before end if bounded.
+// Else nothing past the terminating 0 may be read: the bytes up to it are copied, followed by 0s, which no caller takes for a digit.
+template<bool bounded>
+static inline bool load8(const char* p, const char* end, uint64_t& chunk) {
+    if (bounded) {
+        if (end - p < 8) return false;
+        memcpy(&chunk, p, 8);
+        return true;
+    }
+    chunk = 0;
+    for (int i = 0; i < 8; i++) {
+        const unsigned char c = (unsigned char)p[i];
+        if (!c) break;
+        chunk |= (uint64_t)c << (8 * i); // in a register, storing bytes and loading them as one would stall
+    }
+    return true;
+}
+
+// the amount of digits at the start of chunk, 0 ... 8
+static inline int leading_digits(uint64_t chunk) {
+    // digits become bytes 0 ... 9, for which neither they nor they + 0x76 have the high bit set
+    // a carry out of a byte only happens for non-digits, so it cannot hide the first one
+    const uint64_t x = chunk ^ 0x3030303030303030ull;
+    const uint64_t m = ((x + 0x7676767676767676ull) | x) & 0x8080808080808080ull;
+    return m ? (int)(ctz64(m) >> 3) : 8;
+}
+
+// the value of 8 digits, combining pairs, then pairs of pairs, then pairs of those with multiply-adds
+static inline uint32_t parse_eight_digits(uint64_t chunk) {
+    chunk -= 0x3030303030303030ull;
+    chunk = chunk * 10 + (chunk >> 8);
+    chunk = ((chunk & 0x000000ff000000ffull) * (100 + (1000000ull << 32)) + ((chunk >> 16) & 0x000000ff000000ffull) * (1 + (10000ull << 32))) >> 32;
+    return (uint32_t)chunk;
+}
+
+// the value of the first 1 <= n <= 8 digits of chunk: shifted to the end, with '0's shifted in
+static inline uint32_t parse_digits(uint64_t chunk, int n) {
+    if (n < 8) {
+        const int s = 8 * (8 - n);
+        chunk = chunk << s | 0x3030303030303030ull >> (64 - s);
+    }
+    return parse_eight_digits(chunk);
+}
+
+// consumes up to 8 digits at a time at p while w stays within 19 significant digits, returns how many were consumed
+template<bool bounded>
+static inline int accumulate_digits(const char*& p, const char* end, uint64_t& w, int& significant) {
+    int consumed = 0;
+    uint64_t chunk;
+    while (significant <= 19 - 8 && load8<bounded>(p, end, chunk)) {
+        const int n = leading_digits(chunk);
+        if (!n) break;
+        const uint64_t nonzero = (chunk ^ 0x3030303030303030ull) & (~0ull >> (64 - 8 * n)); // leading '0's are 0 bytes
+        significant += w ? n : nonzero ? n - (int)(ctz64(nonzero) >> 3) : 0;
+        w = w * pow10_u64[n] + parse_digits(chunk, n);
+        p += n;
+        consumed += n;
+        if (n < 8) break;
+    }
+    return consumed;
+}
+
+/*
+parses [+-]?[0-9]*.?[0-9]*([eE][+-]?[0-9]+)? with at least one digit before the exponent at p, not reading at or beyond end if bounded
+returns the end of the number, 0 if there is none
+*/
+template<bool bounded>
+static const char* parse_decimal(const char* p, const char* end, decimal_number& d) {
+    d.negative = false;
+    char c = peek<bounded>(p, end);
+    if (c == '-' || c == '+') {
+        d.negative = c == '-';
+        p++;
+    }
+
+    uint64_t w = 0;
+    int64_t q = 0;
+    int significant = 0;
+    bool truncated = false;
+
+    const char* const int_begin = p;
+    accumulate_digits<bounded>(p, end, w, significant);
+    for (; is_digit(c = peek<bounded>(p, end)); p++) {
+        if (significant < 19) {
+            w = w * 10 + (c - '0');
+            significant += w != 0;
+        }
+        else {
+            q++;
+            truncated |= c != '0';
+        }
+    }
+    bool any = p != int_begin;
+
+    if (c == '.') {
+        const char* const frac_begin = ++p;
+        q -= accumulate_digits<bounded>(p, end, w, significant);
+        for (; is_digit(c = peek<bounded>(p, end)); p++) {
+            if (significant < 19) {
+                w = w * 10 + (c - '0');
+                significant += w != 0;
+                q--;
+            }
+            else truncated |= c != '0';
+        }
+        any |= p != frac_begin;
+    }
+    if (!any) return 0;
+
+    if (c == 'e' || c == 'E') {
+        const char* e = p + 1;
+        c = peek<bounded>(e, end);
+        const bool negative_exponent = c == '-';
+        if (c == '-' || c == '+') c = peek<bounded>(++e, end);
+        if (is_digit(c)) {
+            int64_t x = 0;
+            for (; is_digit(c = peek<bounded>(e, end)); e++) {
+                if (x < 1000000) x = x * 10 + (c - '0'); // way out of range anyways
+            }
+            q += negative_exponent ? -x : x;
+            p = e;
+        }
+    }
+
+    d.w = w;
+    d.q = q;
+    d.truncated = truncated;
+    return p;
+}
+
 template<typename T>
 T strtodf_fast(const char* str, char** endptr) {
-    double ifac = (T)10.0, ffac = (T)1.0, fdfac = (T)1.0;
-    double x = (T)0.0;
-    bool negative = false;
+    decimal_number d;
+    const char* const e = parse_decimal<false>(str, 0, d);
+    if (!e) {
+        *endptr = (char*)str;
+        return 0;
+    }
+    *endptr = (char*)e;
+    return decimal_to_float<T>(d, str, e);
+}
+
+double strtod_fast(const char* str, char** endptr) {
+    return strtodf_fast<double>(str, endptr);
+}
+
+float strtof_fast(const char* str, char** endptr) {
+    return strtodf_fast<float>(str, endptr);
+}
+
+/*
+parses the digits at p into out, which saturates at UINT64_MAX, setting overflow
+returns the end of the digits, 0 if there are none
+*/
+static const char* parse_u64(const char* p, uint64_t& out, bool& overflow) {
+    const char* const begin = p;
+    while (*p == '0') p++;
+    const char* const digits = p;
+
+    // 19 digits never overflow
+    uint64_t v = 0, chunk;
+    for (int k = 0; k < 2 && load8<false>(p, 0, chunk); k++) {
+        const int n = leading_digits(chunk);
+        if (n) v = v * pow10_u64[n] + parse_digits(chunk, n);
+        p += n;
+        if (n < 8) break;
+    }
+    for (; is_digit(*p) && p - digits < 19; p++) v = v * 10 + (*p - '0');
+
+    overflow = false;
+    if (is_digit(*p)) {
+        const unsigned int d = *p++ - '0';
+        overflow = v > (UINT64_MAX - d) / 10;
+        v = overflow ? UINT64_MAX : v * 10 + d;
+        for (; is_digit(*p); p++) overflow = true, v = UINT64_MAX;
+    }
+
+    out = v;
+    return p == begin ? 0 : p;
+}
+
+// T is an integer type of at most 64 bits
+template<typename T>
+static T strtoi_fast(const char* str, char** endptr) {
+    const bool is_signed = (T)-1 < 0;
+    const char* p = str;
+    const bool negative = is_signed && *p == '-';
+    p += negative || *p == '+';
+
+    uint64_t u;
+    bool overflow;
+    const char* const e = parse_u64(p, u, overflow);
+    if (!e) {
+        *endptr = (char*)str;
+        return 0;
+    }
+    *endptr = (char*)e;
+
+    // the largest magnitude representable with this sign
+    const uint64_t limit = !is_signed ? (uint64_t)(T)-1 : negative ? (uint64_t)1 << (sizeof(T) * 8 - 1) : ((uint64_t)1 << (sizeof(T) * 8 - 1)) - 1;
+    if (overflow || u > limit) {
+        errno = ERANGE;
+        u = limit;
+    }
+    return negative ? (T)(0 - u) : (T)u;
+}
+
+int32_t strtoi32_fast(const char* str, char** endptr) {
+    return strtoi_fast<int32_t>(str, endptr);
+}
+
+int64_t strtoi64_fast(const char* str, char** endptr) {
+    return strtoi_fast<int64_t>(str, endptr);
+}
+
+uint32_t strtou32_fast(const char* str, char** endptr) {
+    return strtoi_fast<uint32_t>(str, endptr);
+}
+
+uint64_t strtou64_fast(const char* str, char** endptr) {
+    return strtoi_fast<uint64_t>(str, endptr);
+}
+
+// Batch parsing
+
+// bit i set iff p[i] is a decimal digit, for the 16 bytes starting at p
+static inline uint32_t digit_mask16(__m128i x) {
+    const __m128i ge0 = _mm_cmpgt_epi8(x, _mm_set1_epi8('0' - 1));
+    const __m128i le9 = _mm_cmplt_epi8(x, _mm_set1_epi8('9' + 1));
+    return (uint32_t)_mm_movemask_epi8(_mm_and_si128(ge0, le9));
+}
+
+// bit i set iff p[i] is delim or whitespace, for the 64 bytes starting at p
+static inline uint64_t separator_mask64(const char* p, char delim) {
+#ifdef __AVX2__
+    uint64_t m = 0;
+    for (int i = 0; i < 64; i += 32) {
+        const __m256i x = _mm256_loadu_si256((const __m256i*)(p + i));
+        const __m256i s = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8(delim)), _mm256_cmpeq_epi8(x, _mm256_set1_epi8(' '))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\r'))));
+        const __m256i t = _mm256_or_si256(s, _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\t')));
+        m |= (uint64_t)(uint32_t)_mm256_movemask_epi8(t) << i;
+    }
+    return m;
+#else
+    uint64_t m = 0;
+    for (int i = 0; i < 64; i += 16) {
+        const __m128i x = _mm_loadu_si128((const __m128i*)(p + i));
+        const __m128i s = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(delim)), _mm_cmpeq_epi8(x, _mm_set1_epi8(' '))),
+            _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(x, _mm_set1_epi8('\r'))));
+        const __m128i t = _mm_or_si128(s, _mm_cmpeq_epi8(x, _mm_set1_epi8('\t')));
+        m |= (uint64_t)(uint32_t)_mm_movemask_epi8(t) << i;
+    }
+    return m;
+#endif
+}
+
+// tail_mask_table + 16 - n holds 16 bytes of which the last n are 0xff
+static const uint8_t tail_mask_table[32] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+};
+
+static inline __m128i tail_mask(int n) {
+    return _mm_loadu_si128((const __m128i*)(tail_mask_table + n));
+}
+
+/*
+parses the token [s, e) of the form [0-9]*.?[0-9]* with 1 <= e - s <= 16, all in one 16 byte register
+reads the 16 bytes before e, which must be readable
+returns false if the token is not of that form, exponents are left to parse_decimal
+*/
+static inline bool parse_decimal_token16(const char* s, const char* e, decimal_number& out) {
+    const int length = (int)(e - s);
+    const __m128i x = _mm_loadu_si128((const __m128i*)(e - 16));
+    const uint32_t token = 0xffffu << (16 - length) & 0xffffu;
+    const uint32_t digits = digit_mask16(x) & token;
+    const uint32_t other = token & ~digits;
+
+    // at most one non-digit, the '.', and at least one digit
+    // branch free on the shape of the token, since that is unpredictable
+    const int dot = other ? (int)ctz64(other) : -1;
+    const bool bad = (other & (other - 1)) | (other && e[dot - 16] != '.') | (digits == 0);
+    if (bad) return false;
+    const int fraction = 15 - dot; // digits after the '.', 16 if there is none
+
+    const __m128i ge0 = _mm_cmpgt_epi8(x, _mm_set1_epi8('0' - 1));
+    const __m128i le9 = _mm_cmplt_epi8(x, _mm_set1_epi8('9' + 1));
+    __m128i v = _mm_and_si128(_mm_sub_epi8(x, _mm_set1_epi8('0')), _mm_and_si128(_mm_and_si128(ge0, le9), tail_mask(length)));
+    // move the integer digits one place to the right, over the '.'
+    const __m128i after = tail_mask(fraction);
+    v = _mm_or_si128(_mm_slli_si128(_mm_andnot_si128(after, v), 1), _mm_and_si128(after, v));
+
+    // 16 digits -> 8 two digit -> 4 four digit -> 2 eight digit numbers
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i m10 = _mm_set_epi16(1, 10, 1, 10, 1, 10, 1, 10);
+    const __m128i m100 = _mm_set_epi16(1, 100, 1, 100, 1, 100, 1, 100);
+    const __m128i m10000 = _mm_set_epi16(1, 10000, 1, 10000, 1, 10000, 1, 10000);
+    __m128i t = _mm_packs_epi32(_mm_madd_epi16(_mm_unpacklo_epi8(v, zero), m10), _mm_madd_epi16(_mm_unpackhi_epi8(v, zero), m10));
+    t = _mm_madd_epi16(t, m100);
+    t = _mm_madd_epi16(_mm_packs_epi32(t, t), m10000);
+    const uint64_t mantissa = (uint64_t)(uint32_t)_mm_cvtsi128_si32(t) * 100000000 + (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(t, 4));
+
+    out.w = mantissa;
+    out.q = -(fraction & 15);
+    out.truncated = false;
+    return true;
+}
+
+// bytes indexed at once in strtodf_fast_batch
+const int batch_segment = 64 * 64;
+
+/*
+first finds all separators in a segment of the input with SIMD, then parses the numbers between them.
+the numbers are independent of each other (unlike when scanning one after the other), 
+so their conversions can overlap
+*/
+template<typename T>
+size_t strtodf_fast_batch(const char* begin, const char* end, char delim, T* out, size_t cap, char** endptr) {
+    size_t n = 0;
+    const char* p = begin; // always at the start of a token or a separator
+    uint16_t starts[batch_segment / 2 + 1], ends[batch_segment / 2 + 1];
+
+    while (p < end && n < cap) {
+        // index one segment
+        const size_t length = end - p < batch_segment ? end - p : batch_segment;
+        size_t nstarts = 0, nends = 0;
+        uint64_t carry = 0; // whether the byte before the current block is not a separator
+        for (size_t b = 0; b < length; b += 64) {
+            uint64_t separators;
+            if (end - (p + b) >= 64) separators = separator_mask64(p + b, delim);
+            else {
+                char tail[64];
+                memset(tail, delim, 64);
+                memcpy(tail, p + b, end - (p + b));
+                separators = separator_mask64(tail, delim);
+            }
+            if (length - b < 64) separators |= ~0ull << (length - b);
+
+            const uint64_t tokens = ~separators;
+            const uint64_t previous = tokens << 1 | carry;
+            carry = tokens >> 63;
+            for (uint64_t m = tokens & ~previous; m; m &= m - 1) starts[nstarts++] = (uint16_t)(b + ctz64(m));
+            for (uint64_t m = separators & previous; m; m &= m - 1) ends[nends++] = (uint16_t)(b + ctz64(m));
+        }
+
+        if (!nends && nstarts) {
+            // a token longer than the segment
+            decimal_number d;
+            const char* const s = p + starts[0];
+            const char* const e = parse_decimal<true>(s, end, d);
+            if (!e || (e < end && !is_separator(*e, delim))) { p = s; break; }
+            out[n++] = decimal_to_float<T>(d, s, e);
+            p = e;
+            continue;
+        }
+
+        size_t i = 0;
+        for (; i < nends && n < cap; i++) {
+            const char* s = p + starts[i];
+            const char* const e = p + ends[i];
+            decimal_number d;
+            const int sign = *s == '-' || *s == '+';
+            d.negative = *s == '-';
+            s += sign;
+            if (e - s <= 16 && e - s > 0 && e - 16 >= begin && parse_decimal_token16(s, e, d)) {
+                out[n++] = decimal_to_float<T>(d, s, e);
+            }
+            else if (parse_decimal<true>(s - sign, e, d) == e) out[n++] = decimal_to_float<T>(d, s - sign, e);
+            else break;
+        }
+        if (i < nends) { p += starts[i]; break; }
+        p += i < nstarts ? starts[i] : length;
+    }
+
+    *endptr = (char*)(p < end ? p : end);
+    return n;
+}
+
+size_t strtod_fast_batch(const char* begin, const char* end, char delim, double* out, size_t cap, char** endptr) {
+    return strtodf_fast_batch<double>(begin, end, delim, out, cap, endptr);
+}
+
+size_t strtof_fast_batch(const char* begin, const char* end, char delim, float* out, size_t cap, char** endptr) {
+    return strtodf_fast_batch<float>(begin, end, delim, out, cap, endptr);
+}
+
+// counts the numbers strtodf_fast_batch would find in [begin, end), if all are valid
+static size_t count_tokens(const char* begin, const char* end, char delim) {
+    size_t n = 0;
+    uint64_t carry = 0;
+    for (const char* p = begin; p < end; p += 64) {
+        uint64_t separators;
+        if (end - p >= 64) separators = separator_mask64(p, delim);
+        else {
+            char tail[64];
+            memset(tail, delim, 64);
+            memcpy(tail, p, end - p);
+            separators = separator_mask64(tail, delim);
+        }
+        const uint64_t tokens = ~separators;
+        n += popcount64(tokens & ~(tokens << 1 | carry));
+        carry = tokens >> 63;
+    }
+    return n;
+}
+
+// Bit arrays
+
+#ifdef __AVX2__
+// the bit counts of the 4 words of v, by looking up the counts of all nibbles with a byte shuffle (Mula)
+static inline __m256i bit_count_epi64(__m256i v) {
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0f);
+    const __m256i counts = _mm256_add_epi8(
+        _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, low)),
+        _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), low)));
+    return _mm256_sad_epu8(counts, _mm256_setzero_si256());
+}
+
+static inline size_t horizontal_sum_epi64(__m256i v) {
+    const __m128i s = _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    return (size_t)(_mm_cvtsi128_si64(s) + _mm_extract_epi64(s, 1));
+}
+#endif
+
+// bit_count_array with the words a[i] & b[i], or a[i] if both is false
+template<bool both>
+static size_t bit_count_words(const uint64_t* a, const uint64_t* b, size_t n) {
+    size_t i = 0, count = 0;
+#if defined(__AVX512F__) && defined(__AVX512VPOPCNTDQ__)
+    __m512i sum = _mm512_setzero_si512();
+    for (; i + 8 <= n; i += 8) {
+        __m512i v = _mm512_loadu_si512(a + i);
+        if (both) v = _mm512_and_si512(v, _mm512_loadu_si512(b + i));
+        sum = _mm512_add_epi64(sum, _mm512_popcnt_epi64(v));
+    }
+    count = (size_t)_mm512_reduce_add_epi64(sum);
+#elif defined(__AVX2__)
+    __m256i sum = _mm256_setzero_si256();
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(a + i));
+        if (both) v = _mm256_and_si256(v, _mm256_loadu_si256((const __m256i*)(b + i)));
+        sum = _mm256_add_epi64(sum, bit_count_epi64(v));
+    }
+    count = horizontal_sum_epi64(sum);
+#endif
+    for (; i < n; i++) count += popcount64(both ? a[i] & b[i] : a[i]);
+    return count;
+}
+
+size_t bit_count_array(const uint64_t* words, size_t n) {
+    return bit_count_words<false>(words, 0, n);
+}
+
+size_t bit_count_and_array(const uint64_t* a, const uint64_t* b, size_t n) {
+    return bit_count_words<true>(a, b, n);
+}
+
+size_t lowest_bit_position_array(const uint64_t* words, size_t n) {
+    size_t i = 0;
+#ifdef __AVX2__
+    // skip 4 zero words at a time
+    for (; i + 4 <= n; i += 4) {
+        const __m256i v = _mm256_loadu_si256((const __m256i*)(words + i));
+        if (!_mm256_testz_si256(v, v)) break;
+    }
+#endif
+    for (; i < n; i++) if (words[i]) return i * 64 + ctz64(words[i]);
+    return SIZE_MAX;
+}
+
+size_t highest_bit_position_array(const uint64_t* words, size_t n) {
+    size_t i = n;
+#ifdef __AVX2__
+    for (; i >= 4; i -= 4) {
+        const __m256i v = _mm256_loadu_si256((const __m256i*)(words + i - 4));
+        if (!_mm256_testz_si256(v, v)) break;
+    }
+#endif
+    while (i--) if (words[i]) return i * 64 + 63 - clz64(words[i]);
+    return SIZE_MAX;
+}
+
+// Finiteness of arrays
+// A float or double is infinite or NaN iff all its exponent bits are set.
+
+static inline bool is_non_finite_bits(uint32_t bits) { return (bits & 0x7f800000u) == 0x7f800000u; }
+static inline bool is_non_finite_bits(uint64_t bits) { return (bits & 0x7ff0000000000000ull) == 0x7ff0000000000000ull; }
+
+// bit j of the result says whether the jth of the 64 values at a is not finite
+template<typename Bits>
+static inline uint64_t non_finite_mask64(const Bits* a) {
+    uint64_t m = 0;
+#if defined(__AVX512F__)
+    if (sizeof(Bits) == 4) {
+        const __m512i e = _mm512_set1_epi32(0x7f800000);
+        for (int j = 0; j < 4; j++)
+            m |= (uint64_t)_mm512_cmpeq_epi32_mask(_mm512_and_si512(_mm512_loadu_si512(a + 16 * j), e), e) << (16 * j);
+    } else {
+        const __m512i e = _mm512_set1_epi64(0x7ff0000000000000ll);
+        for (int j = 0; j < 8; j++)
+            m |= (uint64_t)_mm512_cmpeq_epi64_mask(_mm512_and_si512(_mm512_loadu_si512(a + 8 * j), e), e) << (8 * j);
+    }
+#elif defined(__AVX2__)
+    if (sizeof(Bits) == 4) {
+        const __m256i e = _mm256_set1_epi32(0x7f800000);
+        for (int j = 0; j < 8; j++) {
+            const __m256i v = _mm256_loadu_si256((const __m256i*)(a + 8 * j));
+            m |= (uint64_t)(uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(v, e), e))) << (8 * j);
+        }
+    } else {
+        const __m256i e = _mm256_set1_epi64x(0x7ff0000000000000ll);
+        for (int j = 0; j < 16; j++) {
+            const __m256i v = _mm256_loadu_si256((const __m256i*)(a + 4 * j));
+            m |= (uint64_t)(uint32_t)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(v, e), e))) << (4 * j);
+        }
+    }
+#else
+    if (sizeof(Bits) == 4) {
+        const __m128i e = _mm_set1_epi32(0x7f800000);
+        for (int j = 0; j < 16; j++) {
+            const __m128i v = _mm_loadu_si128((const __m128i*)(a + 4 * j));
+            m |= (uint64_t)(uint32_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(v, e), e))) << (4 * j);
+        }
+    } else {
+        // SSE2 has no 64 bit compare, but the exponent is in the high half, whose compare sets the sign bit of the double
+        const __m128i e = _mm_set1_epi64x(0x7ff0000000000000ll);
+        for (int j = 0; j < 32; j++) {
+            const __m128i v = _mm_loadu_si128((const __m128i*)(a + 2 * j));
+            m |= (uint64_t)(uint32_t)_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi32(_mm_and_si128(v, e), e))) << (2 * j);
+        }
+    }
+#endif
+    return m;
+}
+
+template<typename Bits>
+static size_t find_first_non_finite(const Bits* a, size_t n) {
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64)
+        if (const uint64_t m = non_finite_mask64(a + i)) return i + ctz64(m);
+    for (; i < n; i++) if (is_non_finite_bits(a[i])) return i;
+    return SIZE_MAX;
+}
+
+template<typename Bits>
+static size_t count_non_finite(const Bits* a, size_t n) {
+    size_t i = 0, count = 0;
+    for (; i + 64 <= n; i += 64) count += popcount64(non_finite_mask64(a + i));
+    for (; i < n; i++) count += is_non_finite_bits(a[i]);
+    return count;
+}
+
+size_t findFirstNonFinite(const float* a, size_t n) {
+    return find_first_non_finite((const uint32_t*)a, n);
+}
+
+size_t findFirstNonFinite(const double* a, size_t n) {
+    return find_first_non_finite((const uint64_t*)a, n);
+}
+
+size_t countNonFinite(const float* a, size_t n) {
+    return count_non_finite((const uint32_t*)a, n);
+}
+
+size_t countNonFinite(const double* a, size_t n) {
+    return count_non_finite((const uint64_t*)a, n);
+}
+
+// Half precision and bfloat16
+// Both keep the upper bits of a float: fp16 has 5 exponent and 10 mantissa bits, bfloat16 the 8 exponent bits of float and 7 mantissa bits.
+
+struct half { uint16_t bits; }; // as in paul.h
+struct bfloat16 { uint16_t bits; };
+
+static inline uint32_t float_bits(float f) { uint32_t u; memcpy(&u, &f, 4); return u; }
+static inline float bits_float(uint32_t u) { float f; memcpy(&f, &u, 4); return f; }
+
+// round to nearest even, overflow to inf, NaN stays a (quiet) NaN, subnormals are kept, like vcvtps2ph
+static inline uint16_t float_to_half_bits(uint32_t x) {
+    const uint32_t sign = (x >> 16) & 0x8000;
+    x &= 0x7fffffff;
+    if (x >= 0x7f800000) return (uint16_t)(sign | (x > 0x7f800000 ? 0x7e00 | ((x >> 13) & 0x3ff) : 0x7c00));
+    if (x >= 0x477ff000) return (uint16_t)(sign | 0x7c00); // 65520 and above round to inf
+    if (x < 0x38800000) // subnormal or 0: adding 0.5 aligns the mantissa at the bit of 2^-24 and lets the fpu round
+        return (uint16_t)(sign | (float_bits(bits_float(x) + 0.5f) - 0x3f000000));
+    // rebias the exponent and round the 13 dropped bits, ties to the even neighbour
+    x += ((uint32_t)(15 - 127) << 23) + 0xfff + ((x >> 13) & 1);
+    return (uint16_t)(sign | (x >> 13));
+}
+
+static inline uint32_t half_to_float_bits(uint16_t h) {
+    const uint32_t shifted_exponent = 0x7c00u << 13;
+    uint32_t o = (uint32_t)(h & 0x7fff) << 13;
+    const uint32_t exponent = o & shifted_exponent;
+    o += (uint32_t)(127 - 15) << 23;
+    if (exponent == shifted_exponent) o += (uint32_t)(128 - 16) << 23; // inf or NaN
+    else if (exponent == 0) o = float_bits(bits_float(o + (1u << 23)) - bits_float(113u << 23)); // subnormal, renormalize
+    return o | (uint32_t)(h & 0x8000) << 16;
+}
+
+static inline uint16_t float_to_bfloat16_bits(uint32_t x) {
+    if ((x & 0x7fffffff) > 0x7f800000) return (uint16_t)((x >> 16) | 0x40); // keep NaNs from rounding to inf
+    return (uint16_t)((x + 0x7fff + ((x >> 16) & 1)) >> 16);
+}
+
+half float_to_half(float value) { return {float_to_half_bits(float_bits(value))}; }
+float half_to_float(half value) { return bits_float(half_to_float_bits(value.bits)); }
+bfloat16 float_to_bfloat16(float value) { return {float_to_bfloat16_bits(float_bits(value))}; }
+float bfloat16_to_float(bfloat16 value) { return bits_float((uint32_t)value.bits << 16); }
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+// the bfloat16 rounding of float_to_bfloat16_bits on 8 or 16 floats.
+// vcvtneps2bf16 (AVX512_BF16) is not used, it flushes subnormals to 0.
+#if defined(__AVX512F__)
+static inline __m256i float_to_bfloat16_16(__m512i x) {
+    const __mmask16 nan = _mm512_cmpgt_epu32_mask(_mm512_and_si512(x, _mm512_set1_epi32(0x7fffffff)), _mm512_set1_epi32(0x7f800000));
+    const __m512i odd = _mm512_and_si512(_mm512_srli_epi32(x, 16), _mm512_set1_epi32(1));
+    __m512i r = _mm512_srli_epi32(_mm512_add_epi32(_mm512_add_epi32(x, _mm512_set1_epi32(0x7fff)), odd), 16);
+    r = _mm512_mask_or_epi32(r, nan, _mm512_srli_epi32(x, 16), _mm512_set1_epi32(0x40));
+    return _mm512_cvtepi32_epi16(r);
+}
+#else
+static inline __m128i float_to_bfloat16_8(__m256i x) {
+    const __m256i nan = _mm256_cmpgt_epi32(_mm256_and_si256(x, _mm256_set1_epi32(0x7fffffff)), _mm256_set1_epi32(0x7f800000));
+    const __m256i odd = _mm256_and_si256(_mm256_srli_epi32(x, 16), _mm256_set1_epi32(1));
+    __m256i r = _mm256_srli_epi32(_mm256_add_epi32(_mm256_add_epi32(x, _mm256_set1_epi32(0x7fff)), odd), 16);
+    r = _mm256_blendv_epi8(r, _mm256_or_si256(_mm256_srli_epi32(x, 16), _mm256_set1_epi32(0x40)), nan);
+    // values are below 2^16, packus does not saturate; it works per 128 bit lane, so restore the order
+    return _mm256_castsi256_si128(_mm256_permute4x64_epi64(_mm256_packus_epi32(r, r), 0x08));
+}
+#endif
+#endif
+
+void float_to_half_array(const float* in, half* out, size_t n) {
+    size_t i = 0;
+#if defined(__AVX512F__)
+    for (; i + 16 <= n; i += 16)
+        _mm256_storeu_si256((__m256i*)(out + i), _mm512_cvtps_ph(_mm512_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+#elif defined(__F16C__)
+    for (; i + 8 <= n; i += 8)
+        _mm_storeu_si128((__m128i*)(out + i), _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+#endif
+    for (; i < n; i++) out[i] = float_to_half(in[i]);
+}
+
+void half_to_float_array(const half* in, float* out, size_t n) {
+    size_t i = 0;
+#if defined(__AVX512F__)
+    for (; i + 16 <= n; i += 16) _mm512_storeu_ps(out + i, _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*)(in + i))));
+#elif defined(__F16C__)
+    for (; i + 8 <= n; i += 8) _mm256_storeu_ps(out + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(in + i))));
+#endif
+    for (; i < n; i++) out[i] = half_to_float(in[i]);
+}
+
+void float_to_bfloat16_array(const float* in, bfloat16* out, size_t n) {
+    size_t i = 0;
+#if defined(__AVX512F__)
+    for (; i + 16 <= n; i += 16) _mm256_storeu_si256((__m256i*)(out + i), float_to_bfloat16_16(_mm512_loadu_si512(in + i)));
+#elif defined(__AVX2__)
+    for (; i + 8 <= n; i += 8) _mm_storeu_si128((__m128i*)(out + i), float_to_bfloat16_8(_mm256_loadu_si256((const __m256i*)(in + i))));
+#endif
+    for (; i < n; i++) out[i] = float_to_bfloat16(in[i]);
+}
+
+void bfloat16_to_float_array(const bfloat16* in, float* out, size_t n) {
+    size_t i = 0;
+#if defined(__AVX512F__)
+    for (; i + 16 <= n; i += 16)
+        _mm512_storeu_si512(out + i, _mm512_slli_epi32(_mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i*)(in + i))), 16));
+#elif defined(__AVX2__)
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_si256((__m256i*)(out + i), _mm256_slli_epi32(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(in + i))), 16));
+#else
+    for (; i + 8 <= n; i += 8) { // interleaving 0s below the bits makes the floats
+        const __m128i b = _mm_loadu_si128((const __m128i*)(in + i));
+        _mm_storeu_si128((__m128i*)(out + i), _mm_unpacklo_epi16(_mm_setzero_si128(), b));
+        _mm_storeu_si128((__m128i*)(out + i + 4), _mm_unpackhi_epi16(_mm_setzero_si128(), b));
+    }
+#endif
+    for (; i < n; i++) out[i] = bfloat16_to_float(in[i]);
+}
+
+// Memory mapped files
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+// runs chunk(0) ... chunk(threads - 1) in parallel, chunk(0) on the calling thread
+template<typename F>
+static void parallel(unsigned int threads, F chunk) {
+    std::vector<std::thread> workers;
+    for (unsigned int i = 1; i < threads; i++) workers.emplace_back(chunk, i);
+    chunk(0u);
+    for (auto& w : workers) w.join();
+}
+
+static unsigned int default_threads(unsigned int threads) {
+    if (!threads) threads = std::thread::hardware_concurrency();
+    return threads ? threads : 1;
+}
+
+const unsigned int MAP_FILE_PREFETCH = 1; // as in paul.h
+const unsigned int MAP_FILE_COPY_ON_WRITE = 2; // as in paul.h
+
+const char* map_file(const char* path, size_t* size, unsigned int flags) {
+    static const char empty[1] = {0};
+    const bool prefetch = flags & MAP_FILE_PREFETCH, copy_on_write = flags & MAP_FILE_COPY_ON_WRITE;
+    *size = 0;
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, prefetch ? FILE_FLAG_SEQUENTIAL_SCAN : 0, 0);
+    if (file == INVALID_HANDLE_VALUE) return 0;
+    LARGE_INTEGER length;
+    if (!GetFileSizeEx(file, &length)) { CloseHandle(file); return 0; }
+    if (!length.QuadPart) { CloseHandle(file); return empty; }
+    HANDLE mapping = CreateFileMappingA(file, 0, copy_on_write ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, 0);
+    CloseHandle(file);
+    if (!mapping) return 0;
+    const char* const data = (const char*)MapViewOfFile(mapping, copy_on_write ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping); // the view keeps the mapping alive
+    if (!data) return 0;
+    *size = (size_t)length.QuadPart;
+#else
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) return 0;
+    struct stat st;
+    if (fstat(fd, &st)) { close(fd); return 0; }
+    if (!st.st_size) { close(fd); return empty; }
+    void* const data = mmap(0, (size_t)st.st_size, copy_on_write ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping keeps the file open
+    if (data == MAP_FAILED) return 0;
+    if (prefetch) madvise(data, (size_t)st.st_size, MADV_WILLNEED);
+    *size = (size_t)st.st_size;
+#endif
+    return (const char*)data;
+}
+
+void unmap_file(const char* data, size_t size) {
+    if (!size) return;
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+#else
+    munmap((void*)data, size);
+#endif
+}
+
+// Page backed arrays
+
+const size_t huge_page_size = 2 << 20;
+
+static inline size_t round_up(size_t n, size_t m) {
+    return (n + m - 1) / m * m;
+}
+
+#ifndef _WIN32
+// a fresh zeroed mapping of size bytes aligned to alignment (a power of two)
+static void* map_aligned(size_t size, size_t alignment, bool huge) {
+#ifdef MAP_HUGETLB
+    if (huge) {
+        void* const p = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED && (uintptr_t)p % alignment == 0) return p;
+        if (p != MAP_FAILED) munmap(p, size);
+    }
+#endif
+    // over-allocate and cut off what lies outside the aligned range
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    const size_t extra = alignment > page ? alignment : 0;
+    char* const p = (char*)mmap(0, size + extra, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) return 0;
+    char* const a = (char*)round_up((uintptr_t)p, alignment);
+    if (a > p) munmap(p, a - p);
+    if (p + extra > a) munmap(a + size, p + extra - a);
+#ifdef MADV_HUGEPAGE
+    if (huge) madvise(a, size, MADV_HUGEPAGE); // transparent huge pages
+#endif
+    return a;
+}
+#endif
+
+const unsigned int ARRAY_HUGE_PAGES = 1; // as in paul.h
+
+void* reserve_pages(void* data, size_t* capacity, size_t bytes, size_t alignment, unsigned int flags) {
+    const bool huge = flags & ARRAY_HUGE_PAGES;
+#ifdef _WIN32
+    // large pages need SeLockMemoryPrivilege, without it the allocation fails and normal pages are used
+    const size_t large = huge ? GetLargePageMinimum() : 0;
+    void* p = 0;
+    size_t size = 0;
+    if (large && alignment <= large) {
+        size = round_up(bytes, large);
+        p = VirtualAlloc(0, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+    }
+    if (!p) {
+        size = round_up(bytes, 1 << 16);
+        if (alignment > 1 << 16) return 0; // allocations are aligned to 64 KiB
+        p = VirtualAlloc(0, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        if (!p) return 0;
+    }
+    if (data) {
+        memcpy(p, data, *capacity < size ? *capacity : size);
+        VirtualFree(data, 0, MEM_RELEASE);
+    }
+    *capacity = size;
+    return p;
+#else
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    const size_t size = round_up(bytes, huge ? huge_page_size : page);
+#ifdef MREMAP_MAYMOVE
+    if (data) {
+        // moves the page table entries, not the data. A moved block is only page aligned, and cannot be moved back
+        // if a larger alignment then fails, so for those, and huge pages (2 MiB aligned, see below), only growing in place is tried.
+        void* const p = mremap(data, *capacity, size, alignment <= page && !huge ? MREMAP_MAYMOVE : 0);
+        if (p != MAP_FAILED) {
+#ifdef MADV_HUGEPAGE
+            if (huge) madvise(p, size, MADV_HUGEPAGE);
+#endif
+            *capacity = size;
+            return p;
+        }
+    }
+#endif
+    // huge pages are only used for 2 MiB aligned ranges
+    void* const p = map_aligned(size, huge && alignment < huge_page_size ? huge_page_size : alignment, huge);
+    if (!p) return 0;
+    if (data) {
+        memcpy(p, data, *capacity < size ? *capacity : size);
+        munmap(data, *capacity);
+    }
+    *capacity = size;
+    return p;
+#endif
+}
+
+void release_pages(void* data, size_t capacity) {
+    if (!data) return;
+#ifdef _WIN32
+    VirtualFree(data, 0, MEM_RELEASE);
+#else
+    munmap(data, capacity);
+#endif
+}
+
+// Positioned file writes
+
+intptr_t file_create(const char* path) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_WRITE, 0, 0, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, 0);
+    return file == INVALID_HANDLE_VALUE ? -1 : (intptr_t)file;
+#else
+    return open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+#endif
+}
+
+bool file_write_at(intptr_t file, const void* data, size_t bytes, uint64_t offset) {
+    const char* p = (const char*)data;
+    while (bytes) {
+#ifdef _WIN32
+        OVERLAPPED o = {};
+        o.Offset = (DWORD)offset;
+        o.OffsetHigh = (DWORD)(offset >> 32);
+        DWORD written;
+        if (!WriteFile((HANDLE)file, p, (DWORD)(bytes < (1u << 30) ? bytes : 1u << 30), &written, &o)) return false;
+#else
+        const ssize_t written = pwrite((int)file, p, bytes, (off_t)offset);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return false;
+#endif
+        p += written, bytes -= (size_t)written, offset += (uint64_t)written;
+    }
+    return true;
+}
+
+bool file_close(intptr_t file) {
+#ifdef _WIN32
+    return CloseHandle((HANDLE)file) != 0;
+#else
+    return close((int)file) == 0;
+#endif
+}
+
+// io_uring, with the raw system calls (liburing is not needed for a few writes)
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+
+struct uring {
+    int fd;
+    unsigned int *sq_head, *sq_tail, *sq_mask, *sq_array, *cq_head, *cq_tail, *cq_mask;
+    io_uring_sqe* sqes;
+    io_uring_cqe* cqes;
+    void *sq_ring, *cq_ring;
+    size_t sq_ring_size, cq_ring_size, sqes_size;
+};
+
+void* uring_create(unsigned int entries) {
+    io_uring_params params = {};
+    const int fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (fd < 0) return 0; // an old kernel, or io_uring disabled (e.g. by seccomp)
+    if (!(params.features & IORING_FEAT_RW_CUR_POS)) { close(fd); return 0; } // older than 5.6, without IORING_OP_WRITE
+
+    uring* const r = new uring();
+    r->fd = fd;
+    r->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    r->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single) r->sq_ring_size = r->cq_ring_size = std::max(r->sq_ring_size, r->cq_ring_size);
+    r->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    r->sq_ring = mmap(0, r->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    r->cq_ring = single ? r->sq_ring : mmap(0, r->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    r->sqes = (io_uring_sqe*)mmap(0, r->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (r->sq_ring == MAP_FAILED || r->cq_ring == MAP_FAILED || r->sqes == MAP_FAILED) {
+        if (r->sq_ring != MAP_FAILED) munmap(r->sq_ring, r->sq_ring_size);
+        if (!single && r->cq_ring != MAP_FAILED) munmap(r->cq_ring, r->cq_ring_size);
+        if (r->sqes != MAP_FAILED) munmap(r->sqes, r->sqes_size);
+        close(fd);
+        delete r;
+        return 0;
+    }
+    char* const sq = (char*)r->sq_ring;
+    char* const cq = (char*)r->cq_ring;
+    r->sq_head = (unsigned int*)(sq + params.sq_off.head);
+    r->sq_tail = (unsigned int*)(sq + params.sq_off.tail);
+    r->sq_mask = (unsigned int*)(sq + params.sq_off.ring_mask);
+    r->sq_array = (unsigned int*)(sq + params.sq_off.array);
+    r->cq_head = (unsigned int*)(cq + params.cq_off.head);
+    r->cq_tail = (unsigned int*)(cq + params.cq_off.tail);
+    r->cq_mask = (unsigned int*)(cq + params.cq_off.ring_mask);
+    r->cqes = (io_uring_cqe*)(cq + params.cq_off.cqes);
+    return r;
+}
+
+// submits the entries queued and not yet consumed by the kernel, e.g. after an io_uring_enter failed, and waits for min_complete completions
+static bool uring_enter(uring* r, unsigned int min_complete) {
+    for (;;) {
+        const unsigned int pending = *r->sq_tail - __atomic_load_n(r->sq_head, __ATOMIC_ACQUIRE);
+        if (syscall(__NR_io_uring_enter, r->fd, pending, min_complete, min_complete ? IORING_ENTER_GETEVENTS : 0, 0, 0) >= 0) return true;
+        if (errno != EINTR) return errno == EAGAIN || errno == EBUSY; // busy: completions have to be reaped first, the next call submits them
+    }
+}
+
+bool uring_write(void* ring, intptr_t file, const void* data, size_t bytes, uint64_t offset, uint64_t tag) {
+    uring* const r = (uring*)ring;
+    const unsigned int tail = *r->sq_tail; // only this thread submits
+    if (tail - __atomic_load_n(r->sq_head, __ATOMIC_ACQUIRE) > *r->sq_mask) return false; // full
+    const unsigned int i = tail & *r->sq_mask;
+    io_uring_sqe* const sqe = r->sqes + i;
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_WRITE;
+    sqe->fd = (int)file;
+    sqe->addr = (uint64_t)(uintptr_t)data;
+    sqe->len = (uint32_t)(bytes < (1u << 30) ? bytes : 1u << 30);
+    sqe->off = offset;
+    sqe->user_data = tag;
+    r->sq_array[i] = i;
+    __atomic_store_n(r->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    // once queued the write belongs to the ring: if the kernel does not take it now, a later uring_write or uring_wait submits it
+    uring_enter(r, 0);
+    return true;
+}
+
+bool uring_wait(void* ring, uint64_t* tag, int64_t* result) {
+    uring* const r = (uring*)ring;
+    for (;;) {
+        const unsigned int head = *r->cq_head;
+        if (head != __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE)) {
+            const io_uring_cqe& cqe = r->cqes[head & *r->cq_mask];
+            *tag = cqe.user_data;
+            *result = cqe.res;
+            __atomic_store_n(r->cq_head, head + 1, __ATOMIC_RELEASE);
+            return true;
+        }
+        if (!uring_enter(r, 1)) return false;
+    }
+}
+
+void uring_destroy(void* ring) {
+    uring* const r = (uring*)ring;
+    if (!r) return;
+    munmap(r->sqes, r->sqes_size);
+    if (r->cq_ring != r->sq_ring) munmap(r->cq_ring, r->cq_ring_size);
+    munmap(r->sq_ring, r->sq_ring_size);
+    close(r->fd);
+    delete r;
+}
+#else
+void* uring_create(unsigned int) { return 0; }
+bool uring_write(void*, intptr_t, const void*, size_t, uint64_t, uint64_t) { return false; }
+bool uring_wait(void*, uint64_t*, int64_t*) { return false; }
+void uring_destroy(void*) {}
+#endif
+
+// as in paul.h
+template<typename T>
+struct DefaultInitAllocator : std::allocator<T> {
+    template<typename U> struct rebind { typedef DefaultInitAllocator<U> other; };
+    DefaultInitAllocator() = default;
+    template<typename U> DefaultInitAllocator(const DefaultInitAllocator<U>&) noexcept {}
+    template<typename U> void construct(U* p) noexcept(std::is_nothrow_default_constructible<U>::value) { ::new((void*)p) U; }
+    template<typename U, typename... Args> void construct(U* p, Args&&... args) { ::new((void*)p) U(std::forward<Args>(args)...); }
+};
+
+/*
+the file is split into one chunk per thread after separators, so also files of a single line are.
+a first parallel pass counts the numbers in each chunk, which gives every chunk its offset in out,
+a second one parses them into place
+*/
+template<typename T>
+bool strtodf_fast_file(const char* path, char delim, std::vector<T, DefaultInitAllocator<T>>& out, unsigned int threads) {
+    size_t size;
+    const char* const data = map_file(path, &size, MAP_FILE_PREFETCH);
+    if (!data) return false;
+    const char* const end = data + size;
+
+    threads = default_threads(threads);
+    if (size < 1 << 20) threads = 1; // not worth it
+
+    std::vector<const char*> bounds(threads + 1);
+    bounds[0] = data;
+    bounds[threads] = end;
+    for (unsigned int i = 1; i < threads; i++) {
+        const char* p = data + size / threads * i;
+        if (p < bounds[i - 1]) p = bounds[i - 1];
+        while (p < end && !is_separator(*p, delim)) p++;
+        bounds[i] = p < end ? p + 1 : end;
+    }
+
+    std::vector<size_t> offsets(threads + 1);
+    parallel(threads, [&](unsigned int i) {
+        offsets[i + 1] = count_tokens(bounds[i], bounds[i + 1], delim);
+    });
+    for (unsigned int i = 0; i < threads; i++) offsets[i + 1] += offsets[i];
+
+    out.resize(offsets[threads]); // uninitialized, the pages are first touched by the threads parsing into them
+    std::vector<char> ok(threads);
+    parallel(threads, [&](unsigned int i) {
+        char* e;
+        const size_t n = offsets[i + 1] - offsets[i];
+        ok[i] = strtodf_fast_batch<T>(bounds[i], bounds[i + 1], delim, out.data() + offsets[i], n, &e) == n && e == bounds[i + 1];
+    });
+
+    unmap_file(data, size);
+    return std::find(ok.begin(), ok.end(), 0) == ok.end();
+}
+
+bool strtod_fast_file(const char* path, char delim, std::vector<double, DefaultInitAllocator<double>>& out, unsigned int threads) {
+    return strtodf_fast_file<double>(path, delim, out, threads);
+}
+
+bool strtof_fast_file(const char* path, char delim, std::vector<float, DefaultInitAllocator<float>>& out, unsigned int threads) {
+    return strtodf_fast_file<float>(path, delim, out, threads);
+}
 
-    if (*str == '-') {
-        negative = true;
-        str++;
-    }
+#include <math.h>
 
-    for (; ((*str > '0' && *str < '9') || *str == '.') && *str; str++) {
-        if (*str == '.') {
-            ifac = (T)1.0; fdfac = ffac = (T)0.1;
-            continue;
-        }
+// Integer formatting, two digits per division
+
+// "00" "01" ... "99", 200 bytes
+static const char digit_pairs[201] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+int decimal_digits_u64(uint64_t value) {
+    // 1233 / 4096 ~ log10(2), so t is the digit count of the smallest number with as many bits, or one less
+    const uint64_t x = value | 1;
+    const int t = (int)(64 - clz64(x)) * 1233 >> 12;
+    return t + (x >= pow10_u64[t]);
+}
+
+int decimal_digits_u32(uint32_t value) {
+    return decimal_digits_u64(value);
+}
 
-        x *= ifac;
-        x += (*str - '0') * ffac;
-        ffac *= fdfac;
+// writes the lowest n digits of v, the last one at last
+template<typename T>
+static inline void write_digits_backwards(T v, int n, char* last) {
+    for (; n >= 2; n -= 2) {
+        memcpy(last - 1, digit_pairs + 2 * (v % 100), 2);
+        v /= 100;
+        last -= 2;
     }
+    if (n) *last = (char)('0' + v % 10);
+}
 
-    *endptr = (char*)str;
+template<typename T>
+static inline void utostr_fast(T value, char* str, char** endptr) {
+    const int n = decimal_digits_u64(value);
+    write_digits_backwards(value, n, str + n - 1);
+    *endptr = str + n;
+}
 
-    return negative ? -x : x;
+void u32tostr_fast(uint32_t value, char* str, char** endptr) {
+    utostr_fast(value, str, endptr);
 }
 
-double strtod_fast(const char* str, char** endptr) {
-    return strtodf_fast<double>(str, endptr);
+void u64tostr_fast(uint64_t value, char* str, char** endptr) {
+    utostr_fast(value, str, endptr);
 }
 
-float strtof_fast(const char* str, char** endptr) {
-    return strtodf_fast<float>(str, endptr);
+void i32tostr_fast(int32_t value, char* str, char** endptr) {
+    *str = '-';
+    utostr_fast(value < 0 ? 0u - (uint32_t)value : (uint32_t)value, str + (value < 0), endptr);
 }
 
-#include <math.h>
+void i64tostr_fast(int64_t value, char* str, char** endptr) {
+    *str = '-';
+    utostr_fast(value < 0 ? 0ull - (uint64_t)value : (uint64_t)value, str + (value < 0), endptr);
+}
+
+void u32tostr_fast_fixed(uint32_t value, int digits, char* str, char** endptr) {
+    write_digits_backwards(value, digits, str + digits - 1);
+    *endptr = str + digits;
+}
+
+void u64tostr_fast_fixed(uint64_t value, int digits, char* str, char** endptr) {
+    write_digits_backwards(value, digits, str + digits - 1);
+    *endptr = str + digits;
+}
+
+void i32tostr_fast_fixed(int32_t value, int digits, char* str, char** endptr) {
+    *str = value < 0 ? '-' : '+';
+    u32tostr_fast_fixed(value < 0 ? 0u - (uint32_t)value : (uint32_t)value, digits, str + 1, endptr);
+}
+
+void i64tostr_fast_fixed(int64_t value, int digits, char* str, char** endptr) {
+    *str = value < 0 ? '-' : '+';
+    u64tostr_fast_fixed(value < 0 ? 0ull - (uint64_t)value : (uint64_t)value, digits, str + 1, endptr);
+}
 
 // writes digits + 1 characters (adds +- sign) with the last character being at last
 // pads left with 0
 void itoa_backwards_signed(int digits, int i, char* last) {
-    bool negative = false;
-    if (i < 0) {
-        negative = true; i = -i;
-    }
-
-    for (; digits; digits--) {
-        *last-- = '0' + i % 10;
-        i /= 10;
-    }
-    if (negative) *last = '-';
-    else *last = '+';
+    char* e;
+    i32tostr_fast_fixed(i, digits, last - digits, &e);
 }
 
 // writes digits + 1 characters, inserting a dot before the final digit
 void ulltoa_backwards_dotted(int digits, long long i, char* last) {
-    for (; digits>1; digits--) {
-        *last-- = '0' + i % 10;
-        i /= 10;
-    }
-
+    const uint64_t u = (uint64_t)i;
+    const int after = digits > 1 ? digits - 1 : 0; // digits after the dot
+    write_digits_backwards(u, after, last); // 0s beyond the 20 digits of u
+    last -= after;
     *last-- = '.';
-
-    *last = '0' + i % 10;
+    *last = (char)('0' + (after < 20 ? u / pow10_u64[after] % 10 : 0));
 }
 
 template<typename T>
@@ -89,17 +2090,16 @@ void dftostr_fast(
         return;
     }
 
-    if (value < 0) {
-        value = -value; *str++ = '-';
-    }
-    else *str++ = '+';
+    const bool negative = value < 0;
+    if (negative) value = -value;
 
-    
     int EXPONENT = (int)floor(log10(value));
     // TODO handle special cases where pow() cannot be computed because the exponent is too large
     if ((digits - 1) - EXPONENT > 308) goto give0;
     if ((digits - 1) - EXPONENT < -308) goto give0;
 
+    *str++ = negative ? '-' : '+';
+
     // digits are obtained by making value an integer with digits many digits
     long long MANTISSA = value*pow(10., (digits-1)-EXPONENT); // is at 0 based position 'EXPONENT', want to get it to 0-based position digits-1
 
@@ -134,6 +2134,629 @@ void ftostr_fast(
     dftostr_fast<float>(value, digits, str, endptr);
 }
 
+#include <stdio.h>
+
+// Table driven shortest formatting (Grisu2, Florian Loitsch, "Printing Floating-Point Numbers Quickly and Accurately with Integers")
+
+#include <limits>
+
+// f * 2^e
+struct diyfp {
+    uint64_t f;
+    int e;
+};
+
+static inline diyfp diyfp_sub(diyfp x, diyfp y) {
+    return {x.f - y.f, x.e};
+}
+
+// x * y, rounded to the upper 64 bits of the product
+static inline diyfp diyfp_mul(diyfp x, diyfp y) {
+    uint64_t hi;
+    const uint64_t lo = mul128(x.f, y.f, &hi);
+    return {hi + (lo >> 63), x.e + y.e + 64};
+}
+
+static inline diyfp diyfp_normalize(diyfp x) {
+    const int shift = (int)clz64(x.f);
+    return {x.f << shift, x.e - shift};
+}
+
+// v with its neighbourhood (m_minus, m_plus) of values that round to it, m_minus and m_plus with the same exponent
+struct diyfp_boundaries {
+    diyfp v, m_minus, m_plus;
+};
+
+template<typename T>
+static diyfp_boundaries compute_boundaries(T value) {
+    const int precision = std::numeric_limits<T>::digits; // including the hidden bit
+    const int bias = std::numeric_limits<T>::max_exponent - 1 + (precision - 1);
+    const uint64_t hidden_bit = 1ull << (precision - 1);
+
+    uint64_t bits = 0;
+    memcpy(&bits, &value, sizeof(T));
+    const uint64_t E = bits >> (precision - 1), F = bits & (hidden_bit - 1);
+
+    const diyfp v = E ? diyfp{F + hidden_bit, (int)E - bias} : diyfp{F, 1 - bias};
+    // the next smaller value is closer when v is a power of two (and not the smallest normal)
+    const bool lower_closer = F == 0 && E > 1;
+    const diyfp m_plus = diyfp_normalize({2 * v.f + 1, v.e - 1});
+    const diyfp m_minus = lower_closer ? diyfp{4 * v.f - 1, v.e - 2} : diyfp{2 * v.f - 1, v.e - 1};
+    return {diyfp_normalize(v), {m_minus.f << (m_minus.e - m_plus.e), m_plus.e}, m_plus};
+}
+
+// 10^k ~ f * 2^e, for k = -300, -292, ..., 324
+struct cached_power {
+    uint64_t f;
+    int e;
+    int k;
+};
+
+static const cached_power cached_powers[] = {
+    {0xAB70FE17C79AC6CA, -1060, -300},
+    {0xFF77B1FCBEBCDC4F, -1034, -292},
+    {0xBE5691EF416BD60C, -1007, -284},
+    {0x8DD01FAD907FFC3C, -980, -276},
+    {0xD3515C2831559A83, -954, -268},
+    {0x9D71AC8FADA6C9B5, -927, -260},
+    {0xEA9C227723EE8BCB, -901, -252},
+    {0xAECC49914078536D, -874, -244},
+    {0x823C12795DB6CE57, -847, -236},
+    {0xC21094364DFB5637, -821, -228},
+    {0x9096EA6F3848984F, -794, -220},
+    {0xD77485CB25823AC7, -768, -212},
+    {0xA086CFCD97BF97F4, -741, -204},
+    {0xEF340A98172AACE5, -715, -196},
+    {0xB23867FB2A35B28E, -688, -188},
+    {0x84C8D4DFD2C63F3B, -661, -180},
+    {0xC5DD44271AD3CDBA, -635, -172},
+    {0x936B9FCEBB25C996, -608, -164},
+    {0xDBAC6C247D62A584, -582, -156},
+    {0xA3AB66580D5FDAF6, -555, -148},
+    {0xF3E2F893DEC3F126, -529, -140},
+    {0xB5B5ADA8AAFF80B8, -502, -132},
+    {0x87625F056C7C4A8B, -475, -124},
+    {0xC9BCFF6034C13053, -449, -116},
+    {0x964E858C91BA2655, -422, -108},
+    {0xDFF9772470297EBD, -396, -100},
+    {0xA6DFBD9FB8E5B88F, -369, -92},
+    {0xF8A95FCF88747D94, -343, -84},
+    {0xB94470938FA89BCF, -316, -76},
+    {0x8A08F0F8BF0F156B, -289, -68},
+    {0xCDB02555653131B6, -263, -60},
+    {0x993FE2C6D07B7FAC, -236, -52},
+    {0xE45C10C42A2B3B06, -210, -44},
+    {0xAA242499697392D3, -183, -36},
+    {0xFD87B5F28300CA0E, -157, -28},
+    {0xBCE5086492111AEB, -130, -20},
+    {0x8CBCCC096F5088CC, -103, -12},
+    {0xD1B71758E219652C, -77, -4},
+    {0x9C40000000000000, -50, 4},
+    {0xE8D4A51000000000, -24, 12},
+    {0xAD78EBC5AC620000, 3, 20},
+    {0x813F3978F8940984, 30, 28},
+    {0xC097CE7BC90715B3, 56, 36},
+    {0x8F7E32CE7BEA5C70, 83, 44},
+    {0xD5D238A4ABE98068, 109, 52},
+    {0x9F4F2726179A2245, 136, 60},
+    {0xED63A231D4C4FB27, 162, 68},
+    {0xB0DE65388CC8ADA8, 189, 76},
+    {0x83C7088E1AAB65DB, 216, 84},
+    {0xC45D1DF942711D9A, 242, 92},
+    {0x924D692CA61BE758, 269, 100},
+    {0xDA01EE641A708DEA, 295, 108},
+    {0xA26DA3999AEF774A, 322, 116},
+    {0xF209787BB47D6B85, 348, 124},
+    {0xB454E4A179DD1877, 375, 132},
+    {0x865B86925B9BC5C2, 402, 140},
+    {0xC83553C5C8965D3D, 428, 148},
+    {0x952AB45CFA97A0B3, 455, 156},
+    {0xDE469FBD99A05FE3, 481, 164},
+    {0xA59BC234DB398C25, 508, 172},
+    {0xF6C69A72A3989F5C, 534, 180},
+    {0xB7DCBF5354E9BECE, 561, 188},
+    {0x88FCF317F22241E2, 588, 196},
+    {0xCC20CE9BD35C78A5, 614, 204},
+    {0x98165AF37B2153DF, 641, 212},
+    {0xE2A0B5DC971F303A, 667, 220},
+    {0xA8D9D1535CE3B396, 694, 228},
+    {0xFB9B7CD9A4A7443C, 720, 236},
+    {0xBB764C4CA7A44410, 747, 244},
+    {0x8BAB8EEFB6409C1A, 774, 252},
+    {0xD01FEF10A657842C, 800, 260},
+    {0x9B10A4E5E9913129, 827, 268},
+    {0xE7109BFBA19C0C9D, 853, 276},
+    {0xAC2820D9623BF429, 880, 284},
+    {0x80444B5E7AA7CF85, 907, 292},
+    {0xBF21E44003ACDD2D, 933, 300},
+    {0x8E679C2F5E44FF8F, 960, 308},
+    {0xD433179D9C8CB841, 986, 316},
+    {0x9E19DB92B4E31BA9, 1013, 324},
+};
+
+// the product of a normalized diyfp with exponent e and the result will have an exponent in [-60, -32]
+static inline cached_power cached_power_for_binary_exponent(int e) {
+    const int f = -60 - e - 1;
+    const int k = (f * 78913) / (1 << 18) + (f > 0); // ceil(f * log10(2))
+    return cached_powers[(300 + k + 7) / 8];
+}
+
+static const uint32_t pow10_u32[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+static inline void grisu2_round(char* buffer, int length, uint64_t dist, uint64_t delta, uint64_t rest, uint64_t ten_k) {
+    // move towards w while staying inside (M-, M+)
+    while (rest < dist && delta - rest >= ten_k && (rest + ten_k < dist || dist - rest > rest + ten_k - dist)) {
+        buffer[length - 1]--;
+        rest += ten_k;
+    }
+}
+
+// generates the shortest digits of a number in (M_minus, M_plus), as close to w as possible
+// returns their amount, adds their scale to decimal_exponent
+static int grisu2_digit_gen(char* buffer, int& decimal_exponent, diyfp M_minus, diyfp w, diyfp M_plus) {
+    uint64_t delta = diyfp_sub(M_plus, M_minus).f;
+    uint64_t dist = diyfp_sub(M_plus, w).f;
+
+    const diyfp one = {1ull << -M_plus.e, M_plus.e};
+    const uint32_t p1 = (uint32_t)(M_plus.f >> -one.e); // integral part
+    uint64_t p2 = M_plus.f & (one.f - 1); // fractional part
+
+    // digits of the integral part, least significant first (division by a constant, unlike dividing by 10^n)
+    char digits[10];
+    int n = 0;
+    for (uint32_t t = p1; t; t /= 10) digits[n++] = (char)(t % 10);
+
+    int length = 0;
+    uint32_t prefix = 0;
+    while (n > 0) {
+        const char d = digits[--n];
+        buffer[length++] = '0' + d;
+        prefix = prefix * 10 + d;
+        const uint64_t rest = ((uint64_t)(p1 - prefix * pow10_u32[n]) << -one.e) + p2;
+        if (rest <= delta) {
+            decimal_exponent += n;
+            grisu2_round(buffer, length, dist, delta, rest, (uint64_t)pow10_u32[n] << -one.e);
+            return length;
+        }
+    }
+
+    int m = 0;
+    for (;;) {
+        p2 *= 10;
+        buffer[length++] = (char)('0' + (p2 >> -one.e));
+        p2 &= one.f - 1;
+        m++;
+        delta *= 10;
+        dist *= 10;
+        if (p2 <= delta) break;
+    }
+    decimal_exponent -= m;
+    grisu2_round(buffer, length, dist, delta, p2, one.f);
+    return length;
+}
+
+// shortest digits of value > 0 that round to it, value = digits * 10^decimal_exponent
+template<typename T>
+static void grisu2(T value, char* buffer, int& length, int& decimal_exponent) {
+    const diyfp_boundaries b = compute_boundaries(value);
+    const cached_power cached = cached_power_for_binary_exponent(b.m_plus.e);
+    const diyfp c = {cached.f, cached.e};
+
+    const diyfp w = diyfp_mul(b.v, c);
+    const diyfp w_minus = diyfp_mul(b.m_minus, c);
+    const diyfp w_plus = diyfp_mul(b.m_plus, c);
+
+    // the products are exact up to 1 ulp, so shrink the interval to stay safe
+    decimal_exponent = -cached.k;
+    length = grisu2_digit_gen(buffer, decimal_exponent, {w_minus.f + 1, w_minus.e}, w, {w_plus.f - 1, w_plus.e});
+}
+
+// whether the n dropped digits at tail are 5 followed by 0s or 4 followed by 9s
+static bool is_near_tie(const char* tail, int n) {
+    if (tail[0] != '5' && tail[0] != '4') return false;
+    const char rest = tail[0] == '5' ? '0' : '9';
+    for (int i = 1; i < n; i++) if (tail[i] != rest) return false;
+    return true;
+}
+
+template<typename T>
+void dftostr_shortest_fast(
+    T value,
+    int digits,
+    char *str,
+    char** endptr
+    ) {
+    char* const begin = str;
+    *str++ = signbit(value) && value != 0 ? '-' : '+';
+    if (value < 0) value = -value;
+
+    if (!isfinite(value)) {
+        memcpy(str, value != value ? "nan" : "inf", 3);
+        memset(str + 3, ' ', digits + 3);
+        *endptr = begin + digits + 7;
+        return;
+    }
+
+    char buffer[32];
+    int length = 1, exponent = 0;
+    buffer[0] = '0';
+    if (value != 0) {
+        grisu2(value, buffer, length, exponent);
+        exponent += length - 1; // of the first digit
+
+        // too many digits: rounding the shortest digits is rounding twice, which can only go wrong when they are at or next to
+        // a tie (5, 50..., 49...9 after the last kept digit). Only there, round the exact value of value like printf does.
+        if (length > digits && is_near_tie(buffer + digits, length - digits)) {
+            char exact[48];
+            snprintf(exact, sizeof(exact), "%.*e", digits - 1, (double)value);
+            buffer[0] = exact[0];
+            memcpy(buffer + 1, exact + 2, digits - 1);
+            exponent = atoi(strchr(exact, 'e') + 1);
+            length = digits;
+        }
+        else if (length > digits) {
+            length = digits;
+            if (buffer[length] >= '5') {
+                int i = length - 1;
+                for (; i >= 0 && buffer[i] == '9'; i--) buffer[i] = '0';
+                if (i >= 0) buffer[i]++;
+                else { buffer[0] = '1'; exponent++; }
+            }
+        }
+    }
+
+    *str++ = buffer[0];
+    *str++ = '.';
+    memcpy(str, buffer + 1, length - 1);
+    memset(str + length - 1, '0', digits - length);
+    str += digits - 1;
+
+    *str++ = 'e';
+    str += 3;
+    itoa_backwards_signed(3, exponent, str);
+    str++;
+
+    *endptr = str;
+}
+
+void dtostr_shortest_fast(
+    double value,
+    int digits,
+    char *str,
+    char** endptr
+    ) {
+    dftostr_shortest_fast<double>(value, digits, str, endptr);
+}
+
+void ftostr_shortest_fast(
+    float value,
+    int digits,
+    char *str,
+    char** endptr
+    ) {
+    dftostr_shortest_fast<float>(value, digits, str, endptr);
+}
+
+// Text of half precision and bfloat16 values, through float
+
+// value rounded to float with round to odd: truncated, with the last bit set if anything was cut off.
+// Rounding that again to at most 24 - 2 bits gives the same as rounding value directly.
+static float float_round_to_odd(double value) {
+    const float f = (float)value;
+    if ((double)f == value || f != f) return f;
+    uint32_t u = float_bits(f);
+    if (fabs((double)f) > fabs(value)) u--; // rounded away from 0, step back towards it
+    return bits_float(u | 1);
+}
+
+void htostr_fast(half value, int digits, char* str, char** endptr) {
+    dftostr_shortest_fast<float>(half_to_float(value), digits, str, endptr);
+}
+
+void bf16tostr_fast(bfloat16 value, int digits, char* str, char** endptr) {
+    dftostr_shortest_fast<float>(bfloat16_to_float(value), digits, str, endptr);
+}
+
+half strtoh_fast(const char* str, char** endptr) {
+    return float_to_half(float_round_to_odd(strtod_fast(str, endptr)));
+}
+
+bfloat16 strtobf16_fast(const char* str, char** endptr) {
+    return float_to_bfloat16(float_round_to_odd(strtod_fast(str, endptr)));
+}
+
+/*
+every value takes exactly digits + dtostr_fast_extra_chars + 1 characters, so each thread
+formats a contiguous range of values straight to its known place in str
+*/
+template<typename T>
+void dftostr_fast_array(const T* values, size_t n, int digits, char sep, size_t per_line, char* str, char** endptr, unsigned int threads) {
+    const size_t width = digits + 7 + 1; // dtostr_fast_extra_chars and sep
+    threads = default_threads(threads);
+    if (n < 1 << 16) threads = 1; // not worth it
+
+    parallel(threads, [=](unsigned int t) {
+        const size_t first = n / threads * t, last = t + 1 == threads ? n : n / threads * (t + 1);
+        char* e;
+        for (size_t i = first; i < last; i++) {
+            char* const s = str + i * width;
+            dftostr_fast<T>(values[i], digits, s, &e);
+            *e = (per_line && (i + 1) % per_line == 0) || i + 1 == n ? '\n' : sep;
+        }
+    });
+
+    *endptr = str + n * width;
+}
+
+void dtostr_fast_array(const double* values, size_t n, int digits, char sep, size_t per_line, char* str, char** endptr, unsigned int threads) {
+    dftostr_fast_array<double>(values, n, digits, sep, per_line, str, endptr, threads);
+}
+
+void ftostr_fast_array(const float* values, size_t n, int digits, char sep, size_t per_line, char* str, char** endptr, unsigned int threads) {
+    dftostr_fast_array<float>(values, n, digits, sep, per_line, str, endptr, threads);
+}
+
+// Hexadecimal floating point (%a)
+// The mantissa bits are written as they are, 4 per hex digit, the binary exponent in decimal: nothing to round, no tables of powers.
+
+template<typename T> struct hex_format;
+template<> struct hex_format<double> { static const int digits = 13, exponent_digits = 4, chars = 24; };
+template<> struct hex_format<float> { static const int digits = 6, exponent_digits = 3, chars = 16; }; // 23 bits and a 0 bit
+
+// the 8 nibbles of x, highest first, as 8 lowercase hex characters in the bytes of the result, first one lowest
+static inline uint64_t hex_chars8(uint32_t x) {
+    uint64_t v = x;
+    v = (v | v << 16) & 0x0000ffff0000ffffull;
+    v = (v | v << 8) & 0x00ff00ff00ff00ffull;
+    v = (v | v << 4) & 0x0f0f0f0f0f0f0f0full; // nibble i in byte i, i.e. the highest one last
+    v = (v & 0x000000000f0f0f0full) << 32 | (v & 0x0f0f0f0f00000000ull) >> 32;
+    v = (v & 0x00000f0f00000f0full) << 16 | (v & 0x0f0f00000f0f0000ull) >> 16;
+    v = (v & 0x000f000f000f000full) << 8 | (v & 0x0f000f000f000f00ull) >> 8;
+    const uint64_t letters = ((v + 0x0606060606060606ull) >> 4) & 0x0101010101010101ull; // 1 in the bytes of 10 ... 15
+    return v + 0x3030303030303030ull + letters * ('a' - '0' - 10);
+}
+
+/*
+writes [+-]0x[01].<digits hex digits>p[+-]<exponent_digits digits>, chars characters, like %a but with all digits
+subnormals as 0x0.<fraction>p-1022 (-126), zero as 0x0.000...p+0000, infinite values and NaNs as [+-]inf or [+-]nan padded with spaces
+*/
+template<typename T>
+static void dftohex_fast(T value, char* str, char** endptr) {
+    typedef binary_format<T> F;
+    typedef hex_format<T> H;
+    typename F::bits bits;
+    memcpy(&bits, &value, sizeof(T));
+    const bool negative = bits >> (sizeof(T) * 8 - 1);
+    const int power2 = (int)(bits >> F::mantissa_bits) & F::infinite_power;
+    const uint64_t mantissa = (uint64_t)(bits & (((typename F::bits)1 << F::mantissa_bits) - 1)) << (64 - F::mantissa_bits); // left aligned
+    char* const begin = str;
+    *str++ = negative ? '-' : '+';
+    *endptr = begin + H::chars;
+
+    if (power2 == F::infinite_power) {
+        memcpy(str, mantissa ? "nan" : "inf", 3);
+        memset(str + 3, ' ', H::chars - 4);
+        return;
+    }
+
+    memcpy(str, power2 ? "0x1." : "0x0.", 4);
+    str += 4;
+    // 8 characters at a time, the ones past the mantissa are overwritten by the exponent
+    uint64_t chars = hex_chars8((uint32_t)(mantissa >> 32));
+    memcpy(str, &chars, 8);
+    if (H::digits > 8) {
+        chars = hex_chars8((uint32_t)mantissa);
+        memcpy(str + 8, &chars, 8);
+    }
+    str += H::digits;
+    *str++ = 'p';
+    const int exponent = !power2 ? (mantissa ? F::minimum_exponent + 1 : 0) : power2 + F::minimum_exponent;
+    i32tostr_fast_fixed(exponent, H::exponent_digits, str, endptr);
+}
+
+void dtohex_fast(double value, char* str, char** endptr) {
+    dftohex_fast<double>(value, str, endptr);
+}
+
+void ftohex_fast(float value, char* str, char** endptr) {
+    dftohex_fast<float>(value, str, endptr);
+}
+
+// value of the hex digit c, 16 for anything else
+static inline unsigned int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    c |= 0x20;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return 16;
+}
+
+// the amount of hex digits at the start of chunk, 0 ... 8, like leading_digits
+static inline int leading_hex_digits(uint64_t chunk) {
+    // digits become bytes 0 ... 9, lowercased letters 1 ... 6; only invalid bytes carry out of their byte
+    const uint64_t x = chunk ^ 0x3030303030303030ull;
+    const uint64_t y = (chunk | 0x2020202020202020ull) ^ 0x6060606060606060ull;
+    const uint64_t not_digit = (x + 0x7676767676767676ull) | x;
+    const uint64_t not_letter = (y + 0x7979797979797979ull) | y | ~(y + 0x7f7f7f7f7f7f7f7full);
+    const uint64_t m = not_digit & not_letter & 0x8080808080808080ull;
+    return m ? (int)(ctz64(m) >> 3) : 8;
+}
+
+// the value of the first 1 <= n <= 8 hex digits of chunk
+static inline uint32_t parse_hex_digits(uint64_t chunk, int n) {
+    uint64_t t = (chunk & 0x0f0f0f0f0f0f0f0full) + ((chunk >> 6) & 0x0101010101010101ull) * 9; // letters have bit 6 set
+    t <<= 8 * (8 - n); // 0s before
+    t = (t << 4 | t >> 8) & 0x00ff00ff00ff00ffull; // pairs of digits, the first one higher, in the even bytes
+    return (uint32_t)((t & 0xff) << 24 | (t >> 16 & 0xff) << 16 | (t >> 32 & 0xff) << 8 | (t >> 48 & 0xff));
+}
+
+// m * 2^power2, more nonzero bits following m if sticky, correctly rounded (to nearest even)
+template<typename T>
+static T hex_to_float(bool negative, uint64_t m, int64_t power2, bool sticky) {
+    typedef binary_format<T> F;
+    typedef typename F::bits Bits;
+    Bits bits = 0;
+    if (m) {
+        const int z = clz64(m);
+        m <<= z;
+        int64_t e = power2 + 63 - z; // of the highest bit
+        // keep mantissa_bits + 1 bits, fewer for subnormals
+        const int64_t shift = 63 - F::mantissa_bits + (e < F::minimum_exponent + 1 ? F::minimum_exponent + 1 - e : 0);
+        if (e < F::minimum_exponent + 1) e = F::minimum_exponent + 1;
+        uint64_t kept = shift < 64 ? m >> shift : 0;
+        const bool half = shift <= 64 && (m >> (shift - 1) & 1);
+        sticky = sticky || (shift <= 64 ? (shift > 1 && m << (65 - shift) != 0) : m != 0);
+        kept += half && (sticky || (kept & 1));
+        if (kept >> (F::mantissa_bits + 1)) kept >>= 1, e++; // rounded up to the next power of 2
+        if (e > -F::minimum_exponent) bits = (Bits)F::infinite_power << F::mantissa_bits;
+        // subnormals have no hidden bit, so their exponent field stays 0 unless they rounded up to the smallest normal
+        else if (kept >> F::mantissa_bits) bits = (Bits)((uint64_t)(e - F::minimum_exponent) << F::mantissa_bits | (kept & ((1ull << F::mantissa_bits) - 1)));
+        else bits = (Bits)kept;
+    }
+    bits |= (Bits)negative << (sizeof(T) * 8 - 1);
+    T x;
+    memcpy(&x, &bits, sizeof(T));
+    return x;
+}
+
+/*
+parses [+-]?0[xX][0-9a-fA-F]*.?[0-9a-fA-F]*([pP][+-]?[0-9]+)? with at least one hex digit, or [+-]?(inf|nan),
+not reading at or beyond end if bounded.
+returns the end of the number, 0 if there is none
+*/
+template<bool bounded, typename T>
+static const char* parse_hex(const char* p, const char* end, T& out) {
+    bool negative = false;
+    char c = peek<bounded>(p, end);
+    if (c == '-' || c == '+') negative = c == '-', c = peek<bounded>(++p, end);
+    if (c == 'i' || c == 'n') {
+        const char* const word = c == 'i' ? "inf" : "nan";
+        if (peek<bounded>(p + 1, end) != word[1] || peek<bounded>(p + 2, end) != word[2]) return 0;
+        out = c == 'i' ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::quiet_NaN();
+        if (negative) out = -out;
+        return p + 3;
+    }
+    if (c != '0' || (peek<bounded>(p + 1, end) | 0x20) != 'x') return 0;
+    p += 2;
+
+    uint64_t m = 0;
+    int64_t power2 = 0;
+    bool sticky = false, dot = false, any = false;
+    for (;;) {
+        // up to 8 digits at a time, as many as fit into m
+        uint64_t chunk;
+        if (load8<bounded>(p, end, chunk)) {
+            const int n = leading_hex_digits(chunk), room = m ? (int)clz64(m) / 4 : 16;
+            const int k = n < room ? n : room;
+            if (k) {
+                m = m << (4 * k) | parse_hex_digits(chunk, k);
+                power2 -= dot ? 4 * k : 0;
+                p += k;
+                any = true;
+                if (k == 8) continue;
+            }
+        }
+
+        // the dot, the end, or digits beyond the first 16
+        c = peek<bounded>(p, end);
+        if (c == '.' && !dot) { dot = true; p++; continue; }
+        const unsigned int d = hex_value(c);
+        if (d == 16) break;
+        any = true;
+        if (m >> 60) { // full, the digit only matters for rounding
+            sticky = sticky || d;
+            power2 += dot ? 0 : 4;
+        }
+        else {
+            m = m << 4 | d;
+            power2 -= dot ? 4 : 0;
+        }
+        p++;
+    }
+    if (!any) return 0;
+
+    if ((peek<bounded>(p, end) | 0x20) == 'p') {
+        const char* q = p + 1;
+        c = peek<bounded>(q, end);
+        const bool negative_exponent = c == '-';
+        if (c == '-' || c == '+') c = peek<bounded>(++q, end);
+        if (is_digit(c)) {
+            int64_t e = 0;
+            for (; is_digit(c = peek<bounded>(q, end)); q++) if (e < 100000) e = e * 10 + (c - '0');
+            power2 += negative_exponent ? -e : e;
+            p = q;
+        }
+    }
+    out = hex_to_float<T>(negative, m, power2, sticky);
+    return p;
+}
+
+template<typename T>
+static T hextodf_fast(const char* str, char** endptr) {
+    T x = 0;
+    const char* const e = parse_hex<false>(str, 0, x);
+    *endptr = (char*)(e ? e : str);
+    return e ? x : 0;
+}
+
+double hextod_fast(const char* str, char** endptr) {
+    return hextodf_fast<double>(str, endptr);
+}
+
+float hextof_fast(const char* str, char** endptr) {
+    return hextodf_fast<float>(str, endptr);
+}
+
+// like dftostr_fast_array, with the fixed width of dftohex_fast
+template<typename T>
+static void dftohex_fast_array(const T* values, size_t n, char sep, size_t per_line, char* str, char** endptr, unsigned int threads) {
+    const size_t width = hex_format<T>::chars + 1;
+    threads = default_threads(threads);
+    if (n < 1 << 16) threads = 1;
+
+    parallel(threads, [=](unsigned int t) {
+        const size_t first = n / threads * t, last = t + 1 == threads ? n : n / threads * (t + 1);
+        char* e;
+        for (size_t i = first; i < last; i++) {
+            dftohex_fast<T>(values[i], str + i * width, &e);
+            *e = (per_line && (i + 1) % per_line == 0) || i + 1 == n ? '\n' : sep;
+        }
+    });
+
+    *endptr = str + n * width;
+}
+
+void dtohex_fast_array(const double* values, size_t n, char sep, size_t per_line, char* str, char** endptr, unsigned int threads) {
+    dftohex_fast_array<double>(values, n, sep, per_line, str, endptr, threads);
+}
+
+void ftohex_fast_array(const float* values, size_t n, char sep, size_t per_line, char* str, char** endptr, unsigned int threads) {
+    dftohex_fast_array<float>(values, n, sep, per_line, str, endptr, threads);
+}
+
+template<typename T>
+static size_t hextodf_fast_batch(const char* begin, const char* end, char delim, T* out, size_t cap, char** endptr) {
+    size_t n = 0;
+    const char* p = begin;
+    while (p < end && is_separator(*p, delim)) p++;
+    while (p < end && n < cap) {
+        const char* const e = parse_hex<true>(p, end, out[n]);
+        if (!e || (e < end && !is_separator(*e, delim))) break;
+        n++;
+        p = e;
+        while (p < end && is_separator(*p, delim)) p++;
+    }
+    *endptr = (char*)p;
+    return n;
+}
+
+size_t hextod_fast_batch(const char* begin, const char* end, char delim, double* out, size_t cap, char** endptr) {
+    return hextodf_fast_batch<double>(begin, end, delim, out, cap, endptr);
+}
+
+size_t hextof_fast_batch(const char* begin, const char* end, char delim, float* out, size_t cap, char** endptr) {
+    return hextodf_fast_batch<float>(begin, end, delim, out, cap, endptr);
+}
+
 #include <assert.h>
 #include <stdio.h>
 #define _USE_MATH_DEFINES
@@ -161,4 +2784,327 @@ void demo1() {
     e = 0; dtostr_fast(M_E, 17, b, &e); assert(e == b + 24);
     e = 0; dtostr_fast(M_PI, 17, b, &e); assert(e == b + 24);
     e = 0; dtostr_fast(1.234e+250, 17, b, &e); assert(e == b + 24);
-}
\ No newline at end of file
+
+    e = 0; dtohex_fast(M_PI, b, &e); assert(e == b + 24); // the bits of %a, fixed width
+    assert(hextod_fast(b, &e) == M_PI);
+}
+
+// Differential verification of the conversions against the standard library
+
+#include <limits.h>
+#include <cmath>
+#include <charconv>
+#include <chrono>
+#include <random>
+#include <vector>
+
+// distance of a and b in units in the last place, counting the representable values between them. Huge if either is nan.
+template<typename T>
+static uint64_t ulp_distance(T a, T b) {
+    typedef typename binary_format<T>::bits Bits;
+    if (a != a || b != b) return (a != a) == (b != b) ? 0 : UINT64_MAX;
+    Bits x, y;
+    memcpy(&x, &a, sizeof(T));
+    memcpy(&y, &b, sizeof(T));
+    // map to integers ordered like the values, -0 and +0 both to 0
+    const Bits sign = (Bits)1 << (sizeof(T) * 8 - 1);
+    const int64_t ix = x & sign ? -(int64_t)(x & ~sign) : (int64_t)x;
+    const int64_t iy = y & sign ? -(int64_t)(y & ~sign) : (int64_t)y;
+    return ix > iy ? (uint64_t)(ix - iy) : (uint64_t)(iy - ix);
+}
+
+// counts of ulp distances 0, 1, 2, 3-15, 16 or more
+struct ulp_histogram {
+    const char* name;
+    uint64_t counts[5];
+    uint64_t worst;
+
+    void add(uint64_t ulps) {
+        counts[ulps == 0 ? 0 : ulps == 1 ? 1 : ulps == 2 ? 2 : ulps < 16 ? 3 : 4]++;
+        worst = ulps > worst ? ulps : worst;
+    }
+    uint64_t wrong() const { return counts[1] + counts[2] + counts[3] + counts[4]; }
+    void print() const {
+        printf("  %-44s %10llu exact %8llu 1 ulp %8llu 2 ulp %8llu 3-15 ulp %8llu 16+ ulp, worst %llu\n", name,
+            (unsigned long long)counts[0], (unsigned long long)counts[1], (unsigned long long)counts[2],
+            (unsigned long long)counts[3], (unsigned long long)counts[4], (unsigned long long)worst);
+    }
+};
+
+template<typename T>
+static T from_bits(typename binary_format<T>::bits bits) {
+    T v;
+    memcpy(&v, &bits, sizeof(T));
+    return v;
+}
+
+// values that commonly break conversions: zeros, subnormals, extremes, halfway cases, powers of ten and their neighbours
+template<typename T>
+static std::vector<T> edge_values() {
+    typedef typename binary_format<T>::bits Bits;
+    std::vector<T> v = {(T)0, -(T)0, (T)1, (T)0.1, (T)0.5, (T)1e23, (T)9007199254740993., (T)2.2250738585072011e-308,
+        std::numeric_limits<T>::min(), std::numeric_limits<T>::max(), std::numeric_limits<T>::denorm_min(), std::numeric_limits<T>::epsilon()};
+    const Bits steps[] = {1, 2, 3, 0x7ff, (Bits)1 << (binary_format<T>::mantissa_bits - 1), ((Bits)1 << binary_format<T>::mantissa_bits) - 1};
+    for (const Bits b : steps) v.push_back(from_bits<T>(b)); // subnormals
+    for (int e = std::numeric_limits<T>::min_exponent10 - 8; e <= std::numeric_limits<T>::max_exponent10; e++) {
+        const T p = (T)strtod(("1e" + std::to_string(e)).c_str(), 0);
+        v.push_back(p);
+        v.push_back(std::nextafter(p, (T)0));
+        v.push_back(std::nextafter(p, std::numeric_limits<T>::infinity()));
+    }
+    const size_t n = v.size();
+    for (size_t i = 0; i < n; i++) v.push_back(-v[i]);
+    std::vector<T> finite;
+    for (const T x : v) if (std::isfinite(x)) finite.push_back(x);
+    return finite;
+}
+
+template<typename T>
+static std::vector<T> random_values(size_t n, uint64_t seed) {
+    std::vector<T> v;
+    std::mt19937_64 rng(seed);
+    while (v.size() < n) {
+        const T x = from_bits<T>((typename binary_format<T>::bits)rng());
+        if (std::isfinite(x)) v.push_back(x);
+    }
+    return v;
+}
+
+// random decimals of 1 to 25 significant digits and all exponents, often more digits than the type holds
+static std::vector<std::string> random_decimals(size_t n, int max_exponent, uint64_t seed) {
+    std::vector<std::string> v;
+    std::mt19937_64 rng(seed);
+    char b[64];
+    for (size_t i = 0; i < n; i++) {
+        const int digits = 1 + (int)(rng() % 25);
+        int k = 0;
+        if (rng() % 2) b[k++] = '-';
+        b[k++] = (char)('1' + rng() % 9);
+        if (digits > 1) b[k++] = '.';
+        for (int d = 1; d < digits; d++) b[k++] = (char)('0' + rng() % 10);
+        k += snprintf(b + k, sizeof(b) - k, "e%d", (int)(rng() % (2 * max_exponent + 1)) - max_exponent);
+        v.push_back(std::string(b, k));
+    }
+    return v;
+}
+
+struct conversion_timing {
+    const char* name;
+    size_t values, bytes; // bytes of text read or written
+    double seconds;
+};
+
+template<typename F>
+static conversion_timing time_conversion(const char* name, size_t values, F f) {
+    const auto t0 = std::chrono::steady_clock::now();
+    const size_t bytes = f();
+    return {name, values, bytes, std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count()};
+}
+
+// the parsers against strtod/strtof, on the text of the values written by printf and on random decimals
+template<typename T>
+static uint64_t verify_parser(const char* type, const std::vector<T>& values, const std::vector<std::string>& decimals) {
+    const int digits = std::numeric_limits<T>::max_digits10;
+    ulp_histogram printed = {"printf %.*e text", {}, 0}, random = {"random decimals", {}, 0};
+    char b[64];
+    for (const T x : values) {
+        snprintf(b, sizeof(b), "%.*e", digits - 1, (double)x);
+        char* e;
+        const T fast = sizeof(T) == 4 ? (T)strtof_fast(b, &e) : (T)strtod_fast(b, &e);
+        printed.add(*e ? UINT64_MAX : ulp_distance(fast, x));
+    }
+    for (const auto& s : decimals) {
+        char* e;
+        const T reference = sizeof(T) == 4 ? (T)strtof(s.c_str(), 0) : (T)strtod(s.c_str(), 0);
+        const T fast = sizeof(T) == 4 ? (T)strtof_fast(s.c_str(), &e) : (T)strtod_fast(s.c_str(), &e);
+        random.add(*e ? UINT64_MAX : ulp_distance(fast, reference));
+    }
+    printf(" %s against %s\n", sizeof(T) == 4 ? "strtof_fast" : "strtod_fast", type);
+    printed.print();
+    random.print();
+    return printed.wrong() + random.wrong();
+}
+
+// the formatters: the value they read back as, and whether they have the digits of printf %.*e (correct rounding)
+template<typename T>
+static uint64_t verify_formatter(const std::vector<T>& values) {
+    const int digits = std::numeric_limits<T>::max_digits10;
+    const bool is_float = sizeof(T) == 4;
+    ulp_histogram fixed = {is_float ? "ftostr_fast round trip" : "dtostr_fast round trip", {}, 0};
+    ulp_histogram shortest = {is_float ? "ftostr_shortest_fast round trip" : "dtostr_shortest_fast round trip", {}, 0};
+    uint64_t not_correctly_rounded = 0, longer_than_to_chars = 0, written_as_zero = 0;
+    char b[64], c[64], s[64];
+    for (const T x : values) {
+        char* e;
+        if (is_float) ftostr_fast((float)x, digits, b, &e);
+        else dtostr_fast((double)x, digits, b, &e);
+        *e = 0;
+        const T fixed_value = is_float ? (T)strtof(b, 0) : (T)strtod(b, 0);
+        fixed.add(ulp_distance(fixed_value, x));
+        written_as_zero += fixed_value == 0 && x != 0;
+
+        // printf has 2 exponent digits at least, dtostr_fast 3, compare the mantissas and exponent values
+        snprintf(c, sizeof(c), "%+.*e", digits - 1, (double)x);
+        not_correctly_rounded += memcmp(b, c, digits + 2) || atoi(b + digits + 3) != atoi(c + digits + 3);
+
+        if (is_float) ftostr_shortest_fast((float)x, digits, s, &e);
+        else dtostr_shortest_fast((double)x, digits, s, &e);
+        *e = 0;
+        shortest.add(ulp_distance(is_float ? (T)strtof(s, 0) : (T)strtod(s, 0), x));
+
+        // significant digits, without the padding 0s, against the shortest of to_chars
+        const char* const ee = strchr(s, 'e');
+        const char* last = ee - 1;
+        while (*last == '0' || *last == '.') last--;
+        const int significant = (int)(last - s) - (last > s + 1);
+        const auto r = std::to_chars(c, c + sizeof(c), x, std::chars_format::scientific);
+        const char* const ce = std::find((const char*)c, (const char*)r.ptr, 'e');
+        const int reference = (int)(ce - c) - (c[0] == '-') - (std::find((const char*)c, ce, '.') != ce);
+        longer_than_to_chars += significant > reference;
+    }
+    printf(" %s against strtod and printf/to_chars\n", is_float ? "ftostr_fast" : "dtostr_fast");
+    fixed.print();
+    shortest.print();
+    printf("  %-44s %10llu\n  %-44s %10llu\n  %-44s %10llu\n", "fixed digits differing from printf", (unsigned long long)not_correctly_rounded,
+        "fixed written as 0 (exponent out of range)", (unsigned long long)written_as_zero,
+        "shortest digits longer than to_chars", (unsigned long long)longer_than_to_chars);
+    return shortest.wrong(); // the fixed width formatters are not correctly rounded, see the histogram
+}
+
+template<typename T>
+static uint64_t verify_integers(size_t n, uint64_t seed) {
+    std::vector<T> values = {0, 1, 9, 10, std::numeric_limits<T>::max(), (T)(std::numeric_limits<T>::max() - 1), std::numeric_limits<T>::min()};
+    for (T p = 1; p <= std::numeric_limits<T>::max() / 10; p *= 10) values.push_back(p * 10 - 1), values.push_back(p * 10);
+    std::mt19937_64 rng(seed);
+    while (values.size() < n) values.push_back((T)(rng() >> (rng() % 64)) * (std::is_signed<T>::value && rng() % 2 ? (T)-1 : (T)1));
+    uint64_t wrong = 0;
+    char b[32], c[32];
+    for (const T x : values) {
+        char* e;
+        if (sizeof(T) == 8 && std::is_signed<T>::value) i64tostr_fast((int64_t)x, b, &e);
+        else if (sizeof(T) == 8) u64tostr_fast((uint64_t)x, b, &e);
+        else if (std::is_signed<T>::value) i32tostr_fast((int32_t)x, b, &e);
+        else u32tostr_fast((uint32_t)x, b, &e);
+        const auto r = std::to_chars(c, c + sizeof(c), x);
+        wrong += e - b != r.ptr - c || memcmp(b, c, e - b);
+
+        *r.ptr = 0;
+        T parsed = 0;
+        std::from_chars(c, r.ptr, parsed);
+        const T fast = sizeof(T) == 8 ? (std::is_signed<T>::value ? (T)strtoi64_fast(c, &e) : (T)strtou64_fast(c, &e))
+            : (std::is_signed<T>::value ? (T)strtoi32_fast(c, &e) : (T)strtou32_fast(c, &e));
+        wrong += fast != parsed || e != r.ptr;
+    }
+    // out of range saturates, where from_chars reports an error
+    const char* const big = std::is_signed<T>::value ? "-99999999999999999999999" : "99999999999999999999999";
+    char* e;
+    const T fast = sizeof(T) == 8 ? (std::is_signed<T>::value ? (T)strtoi64_fast(big, &e) : (T)strtou64_fast(big, &e))
+        : (std::is_signed<T>::value ? (T)strtoi32_fast(big, &e) : (T)strtou32_fast(big, &e));
+    T parsed;
+    wrong += std::from_chars(big, big + strlen(big), parsed).ec != std::errc::result_out_of_range ||
+        fast != (std::is_signed<T>::value ? std::numeric_limits<T>::min() : std::numeric_limits<T>::max());
+    return wrong;
+}
+
+// all finite floats written by ftostr_shortest_fast and ftostr_fast must read back exactly with strtof_fast
+static uint64_t verify_float32(uint64_t stride, unsigned int threads) {
+    std::vector<uint64_t> failures(threads);
+    const uint64_t total = (1ull << 32) / stride;
+    parallel(threads, [&](unsigned int t) {
+        char b[32];
+        char* e;
+        for (uint64_t i = total * t / threads; i < total * (t + 1) / threads; i++) {
+            const float f = from_bits<float>((uint32_t)(i * stride));
+            if (!std::isfinite(f)) continue;
+            ftostr_shortest_fast(f, 9, b, &e);
+            const float shortest = strtof_fast(b, &e);
+            ftostr_fast(f, 9, b, &e);
+            const float fixed = strtof_fast(b, &e);
+            failures[t] += memcmp(&shortest, &f, 4) != 0;
+            failures[t] += ulp_distance(fixed, f) > 1;
+        }
+    });
+    uint64_t n = 0;
+    for (const uint64_t f : failures) n += f;
+    printf(" float32 round trips, %s (every %llu of 2^32 bit patterns): %llu failures\n",
+        stride == 1 ? "exhaustive" : "sampled", (unsigned long long)stride, (unsigned long long)n);
+    return n;
+}
+
+int verify_conversions(size_t n, bool exhaustive_float32, bool timings) {
+    printf("number conversions, %zu random values per routine\n", n);
+    std::vector<double> doubles = edge_values<double>();
+    std::vector<float> floats = edge_values<float>();
+    const std::vector<double> random_doubles = random_values<double>(n, 1);
+    const std::vector<float> random_floats = random_values<float>(n, 2);
+    doubles.insert(doubles.end(), random_doubles.begin(), random_doubles.end());
+    floats.insert(floats.end(), random_floats.begin(), random_floats.end());
+
+    uint64_t failures = 0;
+    failures += verify_parser<double>("strtod", doubles, random_decimals(n, 330, 3));
+    failures += verify_parser<float>("strtof", floats, random_decimals(n, 48, 4));
+    failures += verify_formatter<double>(doubles);
+    failures += verify_formatter<float>(floats);
+    const uint64_t integers = verify_integers<int32_t>(n, 5) + verify_integers<uint32_t>(n, 6) + verify_integers<int64_t>(n, 7) + verify_integers<uint64_t>(n, 8);
+    printf(" integers against to_chars/from_chars: %llu mismatches\n", (unsigned long long)integers);
+    failures += integers;
+    failures += verify_float32(exhaustive_float32 ? 1 : 4099, default_threads(0));
+
+    if (timings) {
+        std::vector<std::string> texts(random_doubles.size()), ftexts(random_floats.size()), itexts(n);
+        char b[64];
+        for (size_t i = 0; i < n; i++) {
+            snprintf(b, sizeof(b), "%.17g", random_doubles[i]);
+            texts[i] = b;
+            snprintf(b, sizeof(b), "%.9g", (double)random_floats[i]);
+            ftexts[i] = b;
+            snprintf(b, sizeof(b), "%llu", (unsigned long long)(random_doubles[i] != 0 ? (uint64_t)std::fabs(std::fmod(random_doubles[i] * 1e10, 1e19)) : 0));
+            itexts[i] = b;
+        }
+        double dsink = 0;
+        auto parse = [&](const std::vector<std::string>& t, auto f) {
+            return [&t, f, &dsink]() {
+                size_t bytes = 0;
+                for (const auto& s : t) dsink += f(s.data(), s.data() + s.size()) * 1e-300, bytes += s.size();
+                return bytes;
+            };
+        };
+        auto format = [&](auto& values, auto f) {
+            return [&values, f]() {
+                size_t bytes = 0;
+                char b[64];
+                for (const auto x : values) bytes += f(x, b) - b;
+                return bytes;
+            };
+        };
+        std::vector<uint64_t> integers(n);
+        for (size_t i = 0; i < n; i++) integers[i] = strtoull(itexts[i].c_str(), 0, 10);
+
+        std::vector<conversion_timing> t;
+        t.push_back(time_conversion("strtod", n, parse(texts, [](const char* s, const char*) { return strtod(s, 0); })));
+        t.push_back(time_conversion("std::from_chars double", n, parse(texts, [](const char* s, const char* e) { double x = 0; std::from_chars(s, e, x); return x; })));
+        t.push_back(time_conversion("strtod_fast", n, parse(texts, [](const char* s, const char*) { char* e; return strtod_fast(s, &e); })));
+        t.push_back(time_conversion("strtof", n, parse(ftexts, [](const char* s, const char*) { return (double)strtof(s, 0); })));
+        t.push_back(time_conversion("std::from_chars float", n, parse(ftexts, [](const char* s, const char* e) { float x = 0; std::from_chars(s, e, x); return (double)x; })));
+        t.push_back(time_conversion("strtof_fast", n, parse(ftexts, [](const char* s, const char*) { char* e; return (double)strtof_fast(s, &e); })));
+        t.push_back(time_conversion("strtoull", n, parse(itexts, [](const char* s, const char*) { return (double)strtoull(s, 0, 10); })));
+        t.push_back(time_conversion("std::from_chars uint64_t", n, parse(itexts, [](const char* s, const char* e) { uint64_t x = 0; std::from_chars(s, e, x); return (double)x; })));
+        t.push_back(time_conversion("strtou64_fast", n, parse(itexts, [](const char* s, const char*) { char* e; return (double)strtou64_fast(s, &e); })));
+        t.push_back(time_conversion("snprintf %.16e", n, format(random_doubles, [](double x, char* b) { return b + snprintf(b, 64, "%.16e", x); })));
+        t.push_back(time_conversion("std::to_chars double scientific 16", n, format(random_doubles, [](double x, char* b) { return std::to_chars(b, b + 64, x, std::chars_format::scientific, 16).ptr; })));
+        t.push_back(time_conversion("dtostr_fast 17", n, format(random_doubles, [](double x, char* b) { char* e; dtostr_fast(x, 17, b, &e); return e; })));
+        t.push_back(time_conversion("std::to_chars double shortest", n, format(random_doubles, [](double x, char* b) { return std::to_chars(b, b + 64, x).ptr; })));
+        t.push_back(time_conversion("dtostr_shortest_fast 17", n, format(random_doubles, [](double x, char* b) { char* e; dtostr_shortest_fast(x, 17, b, &e); return e; })));
+        t.push_back(time_conversion("snprintf %.8e float", n, format(random_floats, [](float x, char* b) { return b + snprintf(b, 64, "%.8e", (double)x); })));
+        t.push_back(time_conversion("std::to_chars float shortest", n, format(random_floats, [](float x, char* b) { return std::to_chars(b, b + 64, x).ptr; })));
+        t.push_back(time_conversion("ftostr_fast 9", n, format(random_floats, [](float x, char* b) { char* e; ftostr_fast(x, 9, b, &e); return e; })));
+        t.push_back(time_conversion("ftostr_shortest_fast 9", n, format(random_floats, [](float x, char* b) { char* e; ftostr_shortest_fast(x, 9, b, &e); return e; })));
+        t.push_back(time_conversion("snprintf %llu", n, format(integers, [](uint64_t x, char* b) { return b + snprintf(b, 64, "%llu", (unsigned long long)x); })));
+        t.push_back(time_conversion("std::to_chars uint64_t", n, format(integers, [](uint64_t x, char* b) { return std::to_chars(b, b + 64, x).ptr; })));
+        t.push_back(time_conversion("u64tostr_fast", n, format(integers, [](uint64_t x, char* b) { char* e; u64tostr_fast(x, b, &e); return e; })));
+        printf(" throughput (checksum %g)\n", dsink);
+        for (const auto& c : t) printf("  %-44s %8.1f ns/value %8.1f MB/s\n", c.name, c.seconds * 1e9 / c.values, c.bytes / c.seconds * 1e-6);
+    }
+    printf("%llu failures\n", (unsigned long long)failures);
+    return (int)std::min(failures, (uint64_t)INT_MAX);
+}
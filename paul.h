@@ -2,19 +2,46 @@
 
 // Standard headers
 
+#ifdef _WIN32
 #include <sal.h>  // c.f. sal.txt
 
 #define NOMINMAX
 #define WINDOWS_LEAN_AND_MEAN
 #include <windows.h> // OutputDebugStringA, DebugBreak
+#include <intrin.h> // __rdtsc, _ReadWriteBarrier
+#else
+#include <x86intrin.h> // __rdtsc
+#include <signal.h> // raise(SIGTRAP), instead of DebugBreak
+
+// SAL annotations are documentation only outside of MSVC's /analyze
+#define _In_
+#define _In_z_
+#define _In_opt_z_
+#define _In_reads_(n)
+#define _Out_
+#define _Out_opt_
+#define _Out_writes_(n)
+#define _Inout_
+#define DBG_UNREFERENCED_LOCAL_VARIABLE(x) ((void)(x))
+#endif
+#include <emmintrin.h> // SSE2, for FlatHashMap
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+#if defined(PAUL_TRACE_FUNCTIONS) && PAUL_TRACE_FUNCTIONS
+#include <dlfcn.h> // dladdr, to name traced functions
+#include <cxxabi.h> // __cxa_demangle
+#endif
 
 #define _USE_MATH_DEFINES
 #include <math.h>
 #include <float.h>
 #include <limits.h>
 #include <stdio.h>
+#include <stdarg.h>
 #include <memory.h> // just memset, but not malloc/free (no (standard) new/delete either
 #include <string.h>
+#include <locale.h> // setlocale
 
 #include <iostream>
 #include <unordered_map>
@@ -22,17 +49,46 @@
 #include <vector>
 #include <functional>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+
+// C++17 facilities (declared_pure, map_pure, zip_pure) are left out of earlier standards.
+// MSVC reports the standard in _MSVC_LANG only.
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#define PAUL_CPP17 1
+#include <charconv> // from_chars, as a baseline for strtou64_fast
+#else
+#define PAUL_CPP17 0
+#endif
 using namespace std;
 
 // from now on, be very strict
+#ifdef _MSC_VER
 #pragma warning(push, 4)
 #pragma warning(error : 4717) // recursive on all control paths
+#endif
 
 
-#ifndef _WIN64
+#if !defined(_WIN64) && !defined(__LP64__)
 #error Must be compiled in 64 bits.
 #endif
 
+// PRAGMA(x) is #pragma x within macros. MSVC_PRAGMA(x) is that only for MSVC, e.g. for its warning pragmas
+#ifdef _MSC_VER
+#define PRAGMA(x) __pragma(x)
+#define MSVC_PRAGMA(x) __pragma(x)
+#else
+#define PRAGMA(x) _Pragma(#x)
+#define MSVC_PRAGMA(x)
+#endif
+
 
 
 
@@ -95,6 +151,19 @@ CPU_FUNCTION and CUDA_FUNCTION denote functions that use features only available
 // but the function does not modify this environment.
 #define PURITY_ENVIRONMENT_DEPENDENT
 
+// The purity annotations expand to nothing, so facilities relying on purity (map_pure, zip_pure) cannot see them.
+// DECLARE_PURE(f) records that the PURITY_PURE function f is pure, for declared_pure<f>::value.
+// Overloads must be selected with a cast, e.g. DECLARE_PURE((unsigned int(*)(int, unsigned int))mod)
+// Needs C++17 (template<auto>), before that DECLARE_PURE does nothing.
+#if PAUL_CPP17
+template<auto f>
+struct declared_pure : false_type {};
+
+#define DECLARE_PURE(f) template<> struct declared_pure<f> : true_type {}
+#else
+#define DECLARE_PURE(f) static_assert(true, "")
+#endif
+
 
 #ifdef __CUDA_ARCH__
 // use with #if -within- CUDA (__device__) functions -- always 0 outside? Nah, then assert would not work properly
@@ -136,6 +205,21 @@ CPU_FUNCTION and CUDA_FUNCTION denote functions that use features only available
 
 #endif
 
+// A global array of up to 2^64 elements, of which sizevar are in use, in page backed memory aligned to alignment bytes (a power of two).
+// flags: 0 or ARRAY_HUGE_PAGES. Host memory only.
+// Use GLOBALDYNAMICARRAY_RESIZE etc. to change it, name is 0 until then.
+#define GLOBALDYNAMICARRAY_ALIGNED(elementtype, name, sizevar, alignment, flags, usage) size_t sizevar = 0; elementtype* name = 0; ArrayStorage name##_storage = {0, alignment, flags};
+
+// GLOBALDYNAMICARRAY_ALIGNED with 64 byte (cache line, AVX-512 vector) alignment
+#define GLOBALDYNAMICARRAY64(elementtype, name, sizevar, usage) GLOBALDYNAMICARRAY_ALIGNED(elementtype, name, sizevar, 64, 0, usage)
+
+// Sets the size of a GLOBALDYNAMICARRAY_ALIGNED array to n, reallocating if needed. Like realloc, existing elements are kept, new ones are uninitialized.
+#define GLOBALDYNAMICARRAY_RESIZE(name, sizevar, n) resizeArray(name, sizevar, name##_storage, n)
+// Makes room for n elements without changing the size, so later resizes up to n do not reallocate
+#define GLOBALDYNAMICARRAY_RESERVE(name, n) reserveArray(name, name##_storage, n)
+// Releases the memory, the array is empty afterwards
+#define GLOBALDYNAMICARRAY_FREE(name, sizevar) freeArray(name, sizevar, name##_storage)
+
 // Read-only global data
 #ifdef __CUDA_ARCH__
 #define CONSTANTD const __constant__ 
@@ -239,27 +323,107 @@ CPU_FUNCTION and CUDA_FUNCTION denote functions that use features only available
 
 
 
+
+// Assertion failures
+// Within a TEST run by runTests, a failed assertion fails only that test: it throws test_failure, which the runner catches.
+// Within the iterations of a PARALLEL_FOR started by a test, where an exception would terminate the program, it is recorded instead,
+// and the loop continues; the runner fails the test when it returns. Threads started otherwise are not covered.
+// Anywhere else it notifies on all channels and breaks into the debugger.
+struct test_failure : runtime_error {
+    test_failure(const char* s) : runtime_error(s) {}
+};
+
+// the first assertion failure in the parallel loops of a running test
+struct _TestContext {
+    mutex m;
+    string failure;
+};
+
+thread_local bool _inTest = false;
+thread_local _TestContext* _testContext = 0; // of the test running on this thread
+thread_local _TestContext* _parallelTestContext = 0; // of the test whose parallel loop iteration runs on this thread
+
+// sets _parallelTestContext for one iteration of a parallel loop
+struct _ParallelTestScope {
+    _TestContext* const previous;
+    _ParallelTestScope(_TestContext* c) : previous(_parallelTestContext) { _parallelTestContext = c; }
+    ~_ParallelTestScope() { _parallelTestContext = previous; }
+};
+
+// Purity: Has side effects, depends on environment.
+CPU_FUNCTION(void, _assertionFailed, (_In_z_ const char* const s), "Purity: Has side effects, depends on environment.") {
+    if (_TestContext* const c = _parallelTestContext) {
+        lock_guard<mutex> lock(c->m);
+        if (c->failure.empty()) c->failure = s;
+        return;
+    }
+    if (_inTest) throw test_failure(s);
+#ifdef _WIN32
+    /*notify on all channels*/ {puts(s); MessageBoxA(0, s, "Assertion failed", 0); OutputDebugStringA(s);} /*flushStd();*/
+    DebugBreak();
+#else
+    fflush(stdout);
+    fputs(s, stderr);
+    raise(SIGTRAP); // stops in the debugger, terminates otherwise
+#endif
+}
+
+// For code that is rarely executed: kept out of line and away from the hot code, and in failing branches, predicted not taken
+#if defined(__GNUC__) || defined(__clang__)
+#define COLD_FUNCTION __attribute__((cold, noinline))
+#define LIKELY(x) __builtin_expect(!!(x), 1)
+#define UNLIKELY(x) __builtin_expect(!!(x), 0)
+#define PRINTF_FORMAT(formatIndex, firstIndex) __attribute__((__format__(__printf__, formatIndex, firstIndex)))
+#else
+#define COLD_FUNCTION __declspec(noinline)
+#define LIKELY(x) (!!(x))
+#define UNLIKELY(x) (!!(x))
+#define PRINTF_FORMAT(formatIndex, firstIndex)
+#endif
+
+// Formats the message of a failed assert(x, commentFormat, ...) for _assertionFailed. commentFormat starts with "\n\t<".
+// Out of line, so that an assert costs its hot caller only the test, a predicted branch and a call.
+COLD_FUNCTION PRINTF_FORMAT(4, 5) void _assertFailed(_In_z_ const char* file, int line, _In_z_ const char* x, _In_z_ const char* commentFormat, ...) {
+    char comment[10000];
+    va_list args;
+    va_start(args, commentFormat);
+    vsnprintf(comment, sizeof(comment), commentFormat, args);
+    va_end(args);
+    const string s = string(file) + "(" + to_string(line) + ") : Assertion failed : " + x + "." + comment + ">\n";
+    _assertionFailed(s.c_str());
+}
+
+// Assertion levels: which asserts are checked
+#define ASSERT_LEVEL_OFF 0 // none, the condition is not evaluated
+#define ASSERT_LEVEL_DEBUG 1 // those of builds without NDEBUG
+#define ASSERT_LEVEL_ALWAYS 2 // all
+#ifndef PAUL_ASSERT_LEVEL
+#define PAUL_ASSERT_LEVEL ASSERT_LEVEL_ALWAYS
+#endif
 
 #ifndef PAUL_NO_ASSERT
 
 // Better assert
+// assert(x) or assert(x, commentFormat, ...), with commentFormat a printf format literal.
+// An expression, so it may be used like the standard assert.
+#ifdef _MSC_VER
 #pragma warning(disable : 4003) // assert does not need "commentFormat" and its arguments
+#endif
 #undef assert
 #if GPU_CODE
 // #include <assert.h>
 #define assert(x,commentFormat,...) {if(!(x)) {printf("%s(%i) : Assertion failed : %s.\n\tblockIdx %d %d %d, threadIdx %d %d %d\n\t<" commentFormat ">\n", __FILE__, __LINE__, #x, xyz(blockIdx), xyz(threadIdx), __VA_ARGS__); *(int*)0 = 0;/* asm("trap;"); illegal instruction*/} }
+#elif PAUL_ASSERT_LEVEL == ASSERT_LEVEL_ALWAYS || (PAUL_ASSERT_LEVEL == ASSERT_LEVEL_DEBUG && !defined(NDEBUG))
+#define ASSERT_CHECKED 1
+#define assert(x, ...) (LIKELY(x) ? (void)0 : _assertFailed(__FILE__, __LINE__, #x, "\n\t<" __VA_ARGS__))
 #else
-
-#define assert(x,commentFormat,...) {if(!(x)) {char s[10000]; sprintf_s(s, "%s(%i) : Assertion failed : %s.\n\t<" commentFormat ">\n", __FILE__, __LINE__, #x, __VA_ARGS__); /*notify on all channels*/ {puts(s);MessageBoxA(0,s,"Assertion failed",0);OutputDebugStringA(s);} /*flushStd();*/  DebugBreak();  }}
+#define ASSERT_CHECKED 0
+#define assert(x, ...) ((void)sizeof(!(x))) // still compiled, so that variables used only here stay used
 #endif
 
-// assert(false) - wrapper
+// assert(false) - wrapper, checked at every level: the code after it cannot continue
 #define FATAL_ERROR false // make assertion more readable
-#define fatalError(commentFormat, ...) \
-    __pragma(warning(push))\
-    __pragma(warning(disable:4127)) /*Conditional Expression is Constant in assert(false)*/\
-    assert(FATAL_ERROR, "Fatal Error: " commentFormat, __VA_ARGS__); \
-    __pragma(warning(pop))
+#define fatalError(...) _assertFailed(__FILE__, __LINE__, "FATAL_ERROR", "\n\t<Fatal Error: " __VA_ARGS__)
 
 
 
@@ -340,12 +504,9 @@ CPU_FUNCTION and CUDA_FUNCTION denote functions that use features only available
 #define DOINTERVAL(var, minInclusive, maxInclusive) static_assert(minInclusive <= maxInclusive, #minInclusive ", min must be <= max, " #maxInclusive);FOR1(int, var, minInclusive, (maxInclusive)+1)
 
 // Repeatedly execute code with side-effects without any explicit counter
+// The counter is only used by the loop itself, so no compiler warns about it being unreferenced.
 #define REPEAT(times) \
-    DO(__i /*use uncommon/implementation reserved variable to avoid conflicts*/, (times)) \
-    __pragma(warning(push)) \
-    __pragma(warning(disable:4127)) /*Conditional Expression is Constant*/\
-    if (false) DBG_UNREFERENCED_LOCAL_VARIABLE(__i); else /* get rid of unreferenced variable */\
-    __pragma(warning(pop))
+    for (size_t __i /*use uncommon/implementation reserved variable to avoid conflicts*/ = 0, __n = (size_t)(times); __i < __n; __i++)
 
 // for (auto& var : arr) for an arr with size given by arsz and with loop/index i
 #define FOREACHi(i, var, arr, arsz) \
@@ -360,6 +521,46 @@ CPU_FUNCTION and CUDA_FUNCTION denote functions that use features only available
 
 #define FOREACHC(var, arr, arsz)    FOREACHCi(i, var, arr, arsz)
 
+// Parallel variants of the above, with the same syntax and var const in the block that follows,
+// running the iterations on the OpenMP thread pool (which persists between loops). Serial when compiled without /openmp.
+// The iterations must be independent, and the block cannot break out of the loop.
+// Within a test, failed assertions in the iterations are recorded for the test (see _assertionFailed).
+
+// PARALLEL_FOR with the iterations distributed according to chunking, which is the parenthesized argument of OpenMP's schedule clause:
+// (static, grain): consecutive chunks of grain iterations are dealt out round robin in advance, (static) gives each thread one chunk
+// (dynamic, grain): chunks of grain iterations are taken by whichever thread is idle, for iterations of varying cost
+// (guided, grain): like dynamic, but with chunks starting large and shrinking down to grain
+// e.g. PARALLEL_FOR_SCHEDULE((dynamic, 1024), int, i, 0, n, 1) {...}
+#define PARALLEL_FOR_SCHEDULE(chunking, type, var, start, maxExclusive, inc) \
+    BLOCK_DECLARE(_TestContext* const var##_test = _testContext) \
+    PRAGMA(omp parallel for schedule chunking) \
+    for (long long var##_ = (start); var##_ < (long long)(maxExclusive); var##_ += (inc)) /*OpenMP 2 needs a signed counter*/ \
+        BLOCK_DECLARE(const _ParallelTestScope var##_scope(var##_test)) \
+        BLOCK_DECLARE(const type var = (type)var##_)
+
+#define PARALLEL_FOR(type, var, start, maxExclusive, inc) \
+    PARALLEL_FOR_SCHEDULE((static), type, var, start, maxExclusive, inc)
+
+#define PARALLEL_FOR1(type, var, start, maxExclusive) \
+    PARALLEL_FOR(type, var, start, maxExclusive, 1)
+#define PARALLEL_FOR01(type, var, maxExclusive) \
+    PARALLEL_FOR(type, var, 0, maxExclusive, 1)
+
+#define PARALLEL_DO_SCHEDULE(chunking, var, maxExclusive) \
+    PARALLEL_FOR_SCHEDULE(chunking, unsigned int, var, 0, maxExclusive, 1)
+#define PARALLEL_DO(var, maxExclusive) \
+    PARALLEL_DO_SCHEDULE((static), var, maxExclusive)
+#define PARALLEL_DO1(var, maxInclusive) \
+    PARALLEL_FOR(unsigned int, var, 1, (maxInclusive)+1, 1)
+
+#define PARALLEL_FOREACHi(i, var, arr, arsz) \
+    PARALLEL_DO(i, arsz) BLOCK_DECLARE(auto& var = arr[i])
+#define PARALLEL_FOREACH(var, arr, arsz)     PARALLEL_FOREACHi(i, var, arr, arsz)
+
+#define PARALLEL_FOREACHCi(i, var, arr, arsz) \
+    PARALLEL_DO(i, arsz) BLOCK_DECLARE(auto const & var = arr[i])
+#define PARALLEL_FOREACHC(var, arr, arsz)    PARALLEL_FOREACHCi(i, var, arr, arsz)
+
 
 
 
@@ -398,29 +599,355 @@ unsigned int _ntests = 0;
 typedef void(*Test)(void);
 Test _tests[max_tests] = {0};
 const char* _test_names[max_tests] = {0};
+bool _test_serial[max_tests] = {0};
 
 // Purity: Has side effects, depends on environment.
-CPU_FUNCTION(void, addTest, (_In_z_ const char*const n, void f(void)), "Purity: Has side effects, depends on environment.") {
+CPU_FUNCTION(void, addTest, (_In_z_ const char*const n, void f(void), bool serial = false), "Purity: Has side effects, depends on environment.") {
     assert(_ntests < max_tests);
     _test_names[_ntests] = n;
+    _test_serial[_ntests] = serial;
     _tests[_ntests++] = f;
 }
 
 
 #define TESTMSGPREFIX() "======================== "
 
+// s as the contents of a JSON string
+CPU_FUNCTION(string, _jsonEscape, (const string& s), "s escaped for use within a JSON string", PURITY_PURE) {
+    string r;
+    for (const char c : s) {
+        if (c == '"' || c == '\\') r += '\\', r += c;
+        else if (c == '\n') r += "\\n";
+        else if ((unsigned char)c < 0x20) {
+            char u[8];
+            snprintf(u, sizeof(u), "\\u%04x", c);
+            r += u;
+        }
+        else r += c;
+    }
+    return r;
+}
+
+CPU_FUNCTION(bool, _selectedByFilters, (const string& name, const vector<string>& include, const vector<string>& exclude), 
+    "True if name contains one of include (or include is empty) and none of exclude", PURITY_PURE) {
+    auto matches = [&](const vector<string>& filters) {
+        return any_of(filters.begin(), filters.end(), [&](const string& f) {return name.find(f) != string::npos; });
+    };
+    return (include.empty() || matches(include)) && !matches(exclude);
+}
+
+/*
+Runs the registered tests, returns how many failed.
+
+Tests are spread over a work-stealing thread pool: each worker takes tests from the front of its own queue,
+and when that is empty, from the back of another's. Tests declared with TEST_SERIAL run afterwards, one after another on the calling thread.
+A failed assertion fails only its own test (see _assertionFailed), as does any exception escaping the test.
+
+argv (e.g. from main, argv[0] is skipped) may contain
+* name filters: only tests whose name contains one of them run (all if there are none), 
+  and none whose name contains one prefixed with -, e.g. strtod -strtod_fast_file1
+* --shard=i/n: only every n-th of the selected tests, starting at the i-th (0 <= i < n), to split them over processes
+* --threads=k: k workers, default one per core
+* --json=path: writes the results as {"tests":[{"name":..., "passed":..., "seconds":..., "message":...}, ...], "failed":...} to path
+Other arguments starting with -- are rejected, as are malformed ones of these.
+*/
 // Purity: Has side effects, depends on environment.
-CPU_FUNCTION(void, runTests, (), "Purity: Has side effects, depends on environment."){
-    DO(i, _ntests) {
-        cout << TESTMSGPREFIX() << "Test " << i + 1 << "/" << _ntests << ": " << _test_names[i] << endl;
-        _tests[i]();
+CPU_FUNCTION(int, runTests, (int argc, char** argv), "Purity: Has side effects, depends on environment.") {
+    vector<string> include, exclude;
+    unsigned int shard = 0, shards = 1, threads = 0;
+    const char* json = 0;
+    FOR1(int, a, 1, argc) {
+        const char* const arg = argv[a];
+        char rest;
+        if (!strncmp(arg, "--shard=", 8)) {
+            if (sscanf(arg, "--shard=%u/%u%c", &shard, &shards, &rest) != 2 || !shards || shard >= shards) fatalError("%s is not --shard=i/n with 0 <= i < n", arg);
+        }
+        else if (!strncmp(arg, "--threads=", 10)) {
+            if (sscanf(arg, "--threads=%u%c", &threads, &rest) != 1) fatalError("%s is not --threads=k", arg);
+        }
+        else if (!strncmp(arg, "--json=", 7)) json = arg + 7;
+        else if (!strncmp(arg, "--", 2)) fatalError("unknown option %s", arg);
+        else if (arg[0] == '-') exclude.push_back(arg + 1);
+        else include.push_back(arg);
+    }
+
+    vector<unsigned int> selected;
+    DO(i, _ntests) if (_selectedByFilters(_test_names[i], include, exclude)) selected.push_back(i);
+    vector<unsigned int> sharded;
+    DO(i, selected.size()) if (i % shards == shard) sharded.push_back(selected[i]);
+
+    struct Result {
+        bool passed = true;
+        double seconds = 0;
+        string message;
+    };
+    vector<Result> results(_ntests);
+    mutex output;
+    atomic<unsigned int> done(0);
+
+    auto run = [&](const unsigned int i) {
+        Result& r = results[i];
+        const auto t0 = chrono::steady_clock::now();
+        _TestContext context;
+        const bool wasInTest = _inTest; // when runTests is called by a test
+        _TestContext* const previousContext = _testContext;
+        _inTest = true;
+        _testContext = &context;
+        try {
+            _tests[i]();
+        }
+        catch (const exception& e) {
+            r.passed = false;
+            r.message = e.what();
+        }
+        catch (...) {
+            r.passed = false;
+            r.message = "unknown exception";
+        }
+        _inTest = wasInTest;
+        _testContext = previousContext;
+        if (r.passed && !context.failure.empty()) {
+            r.passed = false;
+            r.message = context.failure;
+        }
+        r.seconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+        lock_guard<mutex> lock(output);
+        printf(TESTMSGPREFIX() "Test %u/%zu: %s %s (%.3f s)\n", ++done, sharded.size(), _test_names[i], r.passed ? "passed" : "FAILED", r.seconds);
+        if (!r.passed) printf("%s\n", r.message.c_str());
+        fflush(stdout);
+    };
+
+    // parallel part, round robin over the workers' queues
+    if (!threads) threads = max(1u, thread::hardware_concurrency());
+    struct Queue {
+        mutex m;
+        deque<unsigned int> tests;
+    };
+    vector<Queue> queues(threads);
+    unsigned int k = 0;
+    for (const unsigned int i : sharded) if (!_test_serial[i]) queues[k++ % threads].tests.push_back(i);
+
+    auto worker = [&](const unsigned int w) {
+        for (;;) {
+            unsigned int i = max_tests;
+            for (unsigned int j = 0; j < threads; j++) { // not DO: break and continue would apply to its inner loop
+                Queue& q = queues[(w + j) % threads];
+                lock_guard<mutex> lock(q.m);
+                if (q.tests.empty()) continue;
+                if (j == 0) i = q.tests.front(), q.tests.pop_front();
+                else i = q.tests.back(), q.tests.pop_back(); // steal
+                break;
+            }
+            if (i == max_tests) return; // tests are never added, so all are taken
+            run(i);
+        }
+    };
+    vector<thread> pool;
+    FOR1(unsigned int, w, 1, threads) pool.emplace_back(worker, w);
+    worker(0);
+    for (auto& t : pool) t.join();
+
+    for (const unsigned int i : sharded) if (_test_serial[i]) run(i);
+
+    int failed = 0;
+    for (const unsigned int i : sharded) failed += !results[i].passed;
+
+    FILE* const f = json ? fopen(json, "w") : 0;
+    if (json && !f) fatalError("cannot write %s", json);
+    if (f) {
+        fprintf(f, "{\"tests\":[");
+        DO(j, sharded.size()) {
+            const unsigned int i = sharded[j];
+            fprintf(f, "%s\n{\"name\":\"%s\",\"passed\":%s,\"seconds\":%.6f,\"message\":\"%s\"}", j ? "," : "",
+                _jsonEscape(_test_names[i]).c_str(), results[i].passed ? "true" : "false", results[i].seconds, _jsonEscape(results[i].message).c_str());
+        }
+        fprintf(f, "\n],\"failed\":%d}\n", failed);
+        fclose(f);
     }
-    cout << TESTMSGPREFIX() << "all tests passed" << endl;
+
+    if (failed) cout << TESTMSGPREFIX() << failed << " of " << sharded.size() << " tests failed" << endl;
+    else cout << TESTMSGPREFIX() << "all tests passed" << endl;
+    return failed;
+}
+
+// Runs all tests
+// Purity: Has side effects, depends on environment.
+CPU_FUNCTION(int, runTests, (), "Purity: Has side effects, depends on environment.") {
+    return runTests(0, 0);
 }
 
 // TODO could duplicate tests to CPU and GPU code. Should not matter for most.
 #define TEST(name) void name(); struct T##name {T##name() {addTest(#name,name);}} _T##name; void name() 
 
+// A TEST that runTests does not run concurrently with others, e.g. because it uses many threads itself or global state
+#define TEST_SERIAL(name) void name(); struct T##name {T##name() {addTest(#name,name,true);}} _T##name; void name() 
+
+// Benchmarking framework, like the testing framework
+const unsigned int max_benchmarks = 1000;
+unsigned int _nbenchmarks = 0;
+typedef void(*Benchmark)(void);
+Benchmark _benchmarks[max_benchmarks] = {0};
+const char* _benchmark_names[max_benchmarks] = {0};
+size_t _benchmark_bytes[max_benchmarks] = {0}; // processed per iteration, 0 if not given
+
+// Purity: Has side effects, depends on environment.
+CPU_FUNCTION(void, addBenchmark, (_In_z_ const char*const n, void f(void), size_t bytes = 0), "Purity: Has side effects, depends on environment.") {
+    assert(_nbenchmarks < max_benchmarks);
+    _benchmark_names[_nbenchmarks] = n;
+    _benchmark_bytes[_nbenchmarks] = bytes;
+    _benchmarks[_nbenchmarks++] = f;
+}
+
+// Keeps the compiler from optimizing away the computation of x, e.g. the result of the benchmarked function
+template<typename T>
+CPU_FUNCTION(void, doNotOptimize, (T const& x), "Purity: Has side effects.") {
+#ifdef _MSC_VER
+    _ReadWriteBarrier();
+    *(volatile const char*)&x;
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : "r,m"(x) : "memory");
+#endif
+}
+
+// Advances the 64 bit LCG state (Knuth's MMIX constants) and returns it, for reproducible pseudo random test and benchmark inputs.
+// The low bits have short periods, use the high ones for small ranges.
+CPU_FUNCTION(uint64_t, _testRandom, (_Inout_ uint64_t& state), "Purity: Has side effects.") {
+    return state = state * 6364136223846793005ull + 1442695040888963407ull;
+}
+
+struct BenchmarkStatistics {
+    double median, p99, mean, stddev; // nanoseconds per iteration
+    double cycles; // median cycles (rdtsc) per iteration
+};
+
+// Statistics of the per iteration times in nanoseconds and cycles of a run of samples
+CPU_FUNCTION(BenchmarkStatistics, _benchmarkStatistics, (vector<double> ns, vector<double> cycles), "", PURITY_PURE) {
+    assert(ns.size() > 0 && ns.size() == cycles.size());
+    sort(ns.begin(), ns.end());
+    sort(cycles.begin(), cycles.end());
+    BenchmarkStatistics s;
+    s.median = ns[ns.size() / 2];
+    s.p99 = ns[min(ns.size() - 1, (size_t)ceil(0.99 * ns.size()) - 1)];
+    s.cycles = cycles[cycles.size() / 2];
+    s.mean = 0;
+    for (const double x : ns) s.mean += x;
+    s.mean /= ns.size();
+    double variance = 0;
+    for (const double x : ns) variance += (x - s.mean) * (x - s.mean);
+    s.stddev = sqrt(variance / ns.size());
+    return s;
+}
+
+/*
+Runs the registered benchmarks, returns how many regressed against the baseline.
+
+Each BENCHMARK body is one iteration. It is
+* warmed up for 0.1 s
+* then called in samples of as many iterations as take at least 1 ms (doubling from 1)
+* for 0.5 s (at least 10 samples), timing each sample with steady_clock and rdtsc
+and the median, 99th percentile, mean and standard deviation of the time per iteration is reported,
+as well as the throughput at the median for benchmarks declared with BENCHMARK_BYTES.
+
+argv (e.g. from main, argv[0] is skipped) may contain
+* name filters, like for runTests
+* --baseline=path: compares against the medians saved in path, reporting benchmarks slower by more than the threshold as regressions
+* --threshold=t: relative slowdown for a regression, default 0.1 (10%)
+* --save=path: saves the medians to path (lines of name and nanoseconds), as a baseline for later runs
+Other arguments starting with --, a malformed threshold and files that cannot be read or written are fatal errors.
+*/
+// Purity: Has side effects, depends on environment.
+CPU_FUNCTION(int, runBenchmarks, (int argc, char** argv), "Purity: Has side effects, depends on environment.") {
+    vector<string> include, exclude;
+    const char* baseline = 0;
+    const char* save = 0;
+    double threshold = 0.1;
+    FOR1(int, a, 1, argc) {
+        const char* const arg = argv[a];
+        char rest;
+        if (!strncmp(arg, "--baseline=", 11)) baseline = arg + 11;
+        else if (!strncmp(arg, "--save=", 7)) save = arg + 7;
+        else if (!strncmp(arg, "--threshold=", 12)) {
+            if (sscanf(arg, "--threshold=%lf%c", &threshold, &rest) != 1 || !(threshold >= 0)) fatalError("%s is not --threshold=t with t >= 0", arg);
+        }
+        else if (!strncmp(arg, "--", 2)) fatalError("unknown option %s", arg);
+        else if (arg[0] == '-') exclude.push_back(arg + 1);
+        else include.push_back(arg);
+    }
+
+    unordered_map<string, double> base;
+    if (baseline) {
+        FILE* const f = fopen(baseline, "r");
+        if (!f) fatalError("cannot read %s", baseline);
+        else {
+            char name[1000];
+            double ns;
+            while (fscanf(f, "%999s %lf", name, &ns) == 2) base[name] = ns;
+            fclose(f);
+        }
+    }
+
+    typedef chrono::steady_clock clock;
+    auto seconds_since = [](clock::time_point t0) {return chrono::duration<double>(clock::now() - t0).count(); };
+
+    int regressions = 0;
+    vector<pair<string, double>> medians;
+    DO(b, _nbenchmarks) {
+        if (!_selectedByFilters(_benchmark_names[b], include, exclude)) continue;
+        const Benchmark f = _benchmarks[b];
+
+        for (const auto t0 = clock::now(); seconds_since(t0) < 0.1;) f();
+
+        size_t iterations = 1;
+        for (;; iterations *= 2) {
+            const auto t0 = clock::now();
+            for (size_t i = 0; i < iterations; i++) f();
+            if (seconds_since(t0) >= 1e-3) break;
+        }
+
+        vector<double> ns, cycles;
+        for (const auto start = clock::now(); ns.size() < 10 || seconds_since(start) < 0.5;) {
+            const auto t0 = clock::now();
+            const unsigned long long c0 = __rdtsc();
+            for (size_t i = 0; i < iterations; i++) f();
+            cycles.push_back((double)(__rdtsc() - c0) / iterations);
+            ns.push_back(seconds_since(t0) * 1e9 / iterations);
+        }
+
+        const BenchmarkStatistics s = _benchmarkStatistics(ns, cycles);
+        medians.push_back({_benchmark_names[b], s.median});
+        printf("%-40s median %10.2f ns  p99 %10.2f ns  mean %10.2f ns  stddev %8.2f ns  %10.1f cycles  (%zu x %zu)",
+            _benchmark_names[b], s.median, s.p99, s.mean, s.stddev, s.cycles, ns.size(), iterations);
+        if (_benchmark_bytes[b]) printf("  %.3f GB/s", _benchmark_bytes[b] / s.median);
+        const auto old = base.find(_benchmark_names[b]);
+        if (old != base.end()) {
+            const double change = s.median / old->second - 1;
+            printf("  %+.1f%%%s", 100 * change, change > threshold ? "  REGRESSION" : "");
+            regressions += change > threshold;
+        }
+        printf("\n");
+        fflush(stdout);
+    }
+
+    if (save) {
+        FILE* const f = fopen(save, "w");
+        if (!f) fatalError("cannot write %s", save);
+        else {
+            for (const auto& m : medians) fprintf(f, "%s %.6f\n", m.first.c_str(), m.second);
+            fclose(f);
+        }
+    }
+    if (baseline) cout << TESTMSGPREFIX() << regressions << " regressions" << endl;
+    return regressions;
+}
+
+// The block that follows is one iteration of the benchmark, see runBenchmarks
+#define BENCHMARK(name) void _benchmark_##name(); struct B##name {B##name() {addBenchmark(#name,_benchmark_##name);}} _B##name; void _benchmark_##name() 
+
+// A BENCHMARK that processes bytes (evaluated once, when it is registered) per iteration, reported as GB/s
+#define BENCHMARK_BYTES(name, bytes) void _benchmark_##name(); struct B##name {B##name() {addBenchmark(#name,_benchmark_##name,(bytes));}} _B##name; void _benchmark_##name() 
+
 
 
 
@@ -470,17 +997,36 @@ TEST(testdofor) {
 /*
 like strtod in stdlib, but supports only decimal numbers of the form
 
--?[0-9]*.[0-9]*
+[+-]?[0-9]*.?[0-9]*([eE][+-]?[0-9]+)?
 
-stops parsing when
-* endptr is reached
-* an invalid character is read
+with at least one digit before the exponent. No leading whitespace, inf or nan.
 
-and returns the current intermediate result
+the result is correctly rounded (round to nearest, ties to even), i.e. bit for bit what strtod/strtof give,
+in particular anything written by dtostr_shortest_fast reads back exactly
+(dtostr_fast rounds to its digits, and writes 0 for exponents beyond its tables).
+Numbers with more than 19 significant digits whose rounding they decide go through strtod_l/strtof_l in the "C" locale.
+out of range values become 0 or inf.
+
+*endptr is set to the first character after the number, or to str (returning 0) if there is none
 */
 double strtod_fast(const char* str, char** endptr);
 float strtof_fast(const char* str, char** endptr);
 
+/*
+like strtol/strtoul in stdlib, for decimal integers of the form
+
+[+-]?[0-9]+
+
+('-' only for the signed types). No leading whitespace. Reads 8 digits at a time.
+out of range values saturate to the limits of the type and set errno to ERANGE, like strtol.
+
+*endptr is set to the first character after the number, or to str (returning 0) if there is none
+*/
+int32_t strtoi32_fast(const char* str, char** endptr);
+int64_t strtoi64_fast(const char* str, char** endptr);
+uint32_t strtou32_fast(const char* str, char** endptr);
+uint64_t strtou64_fast(const char* str, char** endptr);
+
 const int dtostr_fast_extra_chars = 1 + 1 + 2 + 3; //  7;
 /* Writes exactly 
 1 (+-) + digits + 1 (.) + 2 (e +/-) + 3 (exponent)
@@ -504,6 +1050,101 @@ void ftostr_fast(
     char** endptr
     );
 
+/*
+like dtostr_fast, with the same fixed width layout, but 
+* uses the shortest digits that read back as value, padded with 0s (round-trip whenever digits >= 17, 9 for float)
+  Like Grisu2, the digits are not the shortest possible in some rare cases, e.g. 9.999999999999999e22 for 1e23
+  With fewer digits than the shortest ones, the result is correctly rounded (ties to even, like printf)
+* finds the digits with integer arithmetic and a table of powers of ten instead of log10/pow
+* supports all finite values, writes [+-]inf or [+-]nan padded with spaces otherwise
+*/
+void dtostr_shortest_fast(
+    double value,
+    int digits,
+    char *str,
+    char** endptr
+    );
+
+void ftostr_shortest_fast(
+    float value,
+    int digits,
+    char *str,
+    char** endptr
+    );
+
+/*
+formats values[0 .. n-1] with dtostr_fast/ftostr_fast into str, each followed by sep,
+or by '\n' if it is the last one or (per_line != 0) the last one of a line of per_line values.
+
+Writes exactly dtostr_fast_array_length(n, digits) characters, using the given amount of threads (0: one per core).
+*/
+void dtostr_fast_array(const double* values, size_t n, int digits, char sep, size_t per_line, char* str, char** endptr, unsigned int threads = 0);
+void ftostr_fast_array(const float* values, size_t n, int digits, char sep, size_t per_line, char* str, char** endptr, unsigned int threads = 0);
+
+FUNCTION(size_t, dtostr_fast_array_length, (const size_t n, const int digits), "Characters written by dtostr_fast_array and ftostr_fast_array", PURITY_PURE) {
+    return n * (digits + dtostr_fast_extra_chars + 1);
+}
+
+const int dtohex_fast_chars = 24, ftohex_fast_chars = 16;
+/*
+writes value exactly in hexadecimal, like printf("%.13a") (%.6a for float, whose 23 mantissa bits get a 0 bit appended),
+in the fixed width layout
+    [+-]0x1.hhhhhhhhhhhhhp[+-]dddd  (dtohex_fast_chars = 24 characters)
+    [+-]0x1.hhhhhhp[+-]ddd          (ftohex_fast_chars = 16 characters)
+subnormals start with 0x0. and have the exponent -1022 (-126), 0 is 0x0.000...p+0000,
+infinite values and NaNs are written as [+-]inf or [+-]nan padded with spaces (losing the NaN's payload).
+
+Only moves bits, so it is much faster than dtostr_fast at 17 digits. *endptr is set past the last character written.
+*/
+void dtohex_fast(double value, char* str, char** endptr);
+void ftohex_fast(float value, char* str, char** endptr);
+
+/*
+like strtod for hexadecimal floating point, of the form
+
+[+-]?0[xX][0-9a-fA-F]*.?[0-9a-fA-F]*([pP][+-]?[0-9]+)?
+
+with at least one hex digit, or [+-]?(inf|nan). No leading whitespace.
+Any amount of digits is read, the result is correctly rounded (to nearest even), out of range values become 0 or inf.
+Reads everything printf's %a and dtohex_fast/ftohex_fast write, the latter back exactly.
+
+*endptr is set to the first character after the number, or to str (returning 0) if there is none
+*/
+double hextod_fast(const char* str, char** endptr);
+float hextof_fast(const char* str, char** endptr);
+
+/*
+formats values[0 .. n-1] with dtohex_fast/ftohex_fast into str, each followed by sep, or by '\n' like dtostr_fast_array.
+Writes exactly n * (dtohex_fast_chars + 1) (ftohex_fast_chars + 1) characters, using the given amount of threads (0: one per core).
+*/
+void dtohex_fast_array(const double* values, size_t n, char sep, size_t per_line, char* str, char** endptr, unsigned int threads = 0);
+void ftohex_fast_array(const float* values, size_t n, char sep, size_t per_line, char* str, char** endptr, unsigned int threads = 0);
+
+// parses all hexadecimal numbers in [begin, end) into out like repeated hextod_fast/hextof_fast, with the separators and stopping rules of strtod_fast_batch
+size_t hextod_fast_batch(const char* begin, const char* end, char delim, double* out, size_t cap, char** endptr);
+size_t hextof_fast_batch(const char* begin, const char* end, char delim, float* out, size_t cap, char** endptr);
+
+/*
+integer formatting, writing two digits at a time from a table of the 100 digit pairs.
+nothing is 0 terminated, *endptr is set past the last character written.
+
+the plain versions write as many digits as needed, with a '-' for negative values (at most 20 characters).
+the _fixed versions write exactly digits digits, padded left with 0s (the lowest digits if value has more),
+signed ones preceded by + or -.
+*/
+void u32tostr_fast(uint32_t value, char* str, char** endptr);
+void u64tostr_fast(uint64_t value, char* str, char** endptr);
+void i32tostr_fast(int32_t value, char* str, char** endptr);
+void i64tostr_fast(int64_t value, char* str, char** endptr);
+void u32tostr_fast_fixed(uint32_t value, int digits, char* str, char** endptr);
+void u64tostr_fast_fixed(uint64_t value, int digits, char* str, char** endptr);
+void i32tostr_fast_fixed(int32_t value, int digits, char* str, char** endptr);
+void i64tostr_fast_fixed(int64_t value, int digits, char* str, char** endptr);
+
+// the amount of decimal digits of value, 1 for 0. Branch free.
+int decimal_digits_u32(uint32_t value);
+int decimal_digits_u64(uint64_t value);
+
 // writes digits + 1 characters with the last character being at last
 // pads left with 0
 void itoa_backwards_signed(int digits, int i, char* last);
@@ -512,9 +1153,64 @@ void itoa_backwards_signed(int digits, int i, char* last);
 // writes digits + 1 characters, inserting a dot before the final digit
 void ulltoa_backwards_dotted(int digits, long long i, char* last);
 
+/*
+parses all numbers in [begin, end) into out, like repeated strtod_fast/strtof_fast (correctly rounded, exponents allowed).
+numbers are separated by delim and/or whitespace (' ', '\t', '\r', '\n'), empty fields are skipped.
+
+stops parsing when
+* end is reached
+* cap numbers have been written
+* a number is malformed or not followed by a separator
+
+returns the amount of numbers written, *endptr is set to where parsing stopped
+*/
+size_t strtod_fast_batch(const char* begin, const char* end, char delim, double* out, size_t cap, char** endptr);
+size_t strtof_fast_batch(const char* begin, const char* end, char delim, float* out, size_t cap, char** endptr);
+
+/*
+maps the file at path into memory, read only. Pages are read lazily when first accessed.
+returns 0 if the file cannot be opened, *size is set to its length in bytes
+*/
+const unsigned int MAP_FILE_PREFETCH = 1; // for reading it all in order: starts reading ahead right away
+const unsigned int MAP_FILE_COPY_ON_WRITE = 2; // the memory may be written, the first write to a page copies it, the file is not changed
+const char* map_file(const char* path, size_t* size, unsigned int flags = MAP_FILE_PREFETCH);
+void unmap_file(const char* data, size_t size);
+
+// an allocator that default-initializes, so resizing a vector of numbers does not write zeros that are overwritten anyway
+template<typename T>
+struct DefaultInitAllocator : std::allocator<T> {
+    template<typename U> struct rebind { typedef DefaultInitAllocator<U> other; };
+    DefaultInitAllocator() = default;
+    template<typename U> DefaultInitAllocator(const DefaultInitAllocator<U>&) noexcept {}
+    template<typename U> void construct(U* p) noexcept(std::is_nothrow_default_constructible<U>::value) { ::new((void*)p) U; }
+    template<typename U, typename... Args> void construct(U* p, Args&&... args) { ::new((void*)p) U(std::forward<Args>(args)...); }
+};
+
+template<typename T>
+using UninitializedVector = vector<T, DefaultInitAllocator<T>>;
+
+/*
+loads all numbers of the text file at path into out (resized to fit, without initializing it first), parsed like strtod_fast_batch
+uses the given amount of threads, 0 for one per core, splitting the file at separators
+
+returns false if the file cannot be read or contains anything else than numbers and separators
+*/
+bool strtod_fast_file(const char* path, char delim, UninitializedVector<double>& out, unsigned int threads = 0);
+bool strtof_fast_file(const char* path, char delim, UninitializedVector<float>& out, unsigned int threads = 0);
+
 // exercises ftostr_fast etc.
 void demo1();
 
+/*
+compares strtod_fast, strtof_fast, dtostr_fast, ftostr_fast, their shortest variants and the integer conversions against strtod, printf and std::to_chars/from_chars
+on edge cases, n random values and random decimals, and the float32 round trip on every 4099th bit pattern or, if exhaustive_float32, on all of them
+prints ulp histograms, mismatch counts and, if timings, ns/value and MB/s of each routine and its standard counterpart
+
+returns the number of failures: parsed values not exactly those of strtod, shortest texts not reading back exactly, integer mismatches
+the fixed width formatters are not correctly rounded in the last digit, their deviations are reported but do not count
+*/
+int verify_conversions(size_t n = 1000000, bool exhaustive_float32 = false, bool timings = true);
+
 
 template<typename T1, typename T2>
 FUNCTION(
@@ -529,116 +1225,3150 @@ FUNCTION(
     return n % m == 0;
 }
 
-TEST(divisible1) {
-    assert(divisible(8u, 8u));
-    assert(divisible(8, 8));
-    assert(!divisible(7, 8));
-    assert(divisible(8000000, 8));
-    assert(!divisible(28, 8));
+TEST(strtod_fast1) {
+    char* e;
+    assert(strtod_fast("90.09", &e) > 90.08 && strtod_fast("90.09", &e) < 90.1);
+    assert(*e == 0);
+    assert(strtod_fast("-0.5,", &e) == -0.5);
+    assert(*e == ',');
+    assert(strtod_fast("+1.25e-3x", &e) == 1.25e-3 && *e == 'x');
+    assert(strtod_fast("7e", &e) == 7. && *e == 'e');
+    assert(strtod_fast(".e1", &e) == 0. && *e == '.');
+    assert(strtod_fast("1e400", &e) == INFINITY && strtod_fast("-1e-400", &e) == 0. && signbit(strtod_fast("-1e-400", &e)));
 }
 
-
-FUNCTION(unsigned int, restrictSize, (const size_t s), "Convert s to unsigned int, undefined (assertion error) if s is too large for this (loss of information would occur)", PURITY_PURE) {
-    assert(s <= 0xffffffffu);
-    return (unsigned int)s;
+TEST(strtoi_fast1) {
+    char* e;
+    assert(strtoi32_fast("-2147483648,", &e) == INT32_MIN && *e == ',');
+    assert(strtoi32_fast("+2147483647", &e) == INT32_MAX && *e == 0);
+    errno = 0;
+    assert(strtoi32_fast("2147483648", &e) == INT32_MAX && errno == ERANGE && *e == 0);
+    assert(strtou64_fast("18446744073709551615", &e) == UINT64_MAX && *e == 0);
+    errno = 0;
+    assert(strtou64_fast("18446744073709551616x", &e) == UINT64_MAX && errno == ERANGE && *e == 'x');
+    assert(strtou64_fast("000000000000000000000000012345678901234567", &e) == 12345678901234567ull && *e == 0);
+    assert(strtou64_fast("-1", &e) == 0 && *e == '-');
+    assert(strtoi64_fast("x", &e) == 0 && *e == 'x');
+    assert(strtou32_fast("4294967296", &e) == UINT32_MAX);
+
+    char b[32];
+    uint64_t r = 1;
+    for (int i = 0; i < 10000; i++) {
+        _testRandom(r);
+        const uint64_t x = r >> (i % 64);
+        i64tostr_fast((int64_t)x, b, &e);
+        *e = 0;
+        assert(strtoi64_fast(b, &e) == (int64_t)x && *e == 0, "%s", b);
+        assert(strtou64_fast(b + (b[0] == '-'), &e) == (b[0] == '-' ? 0 - x : x));
+    }
 }
 
+// bit for bit agreement with strtod/strtof, including halfway cases, subnormals and more than 19 digits
+TEST(strtod_fast2) {
+    const char* const edge[] = {
+        "9007199254740993", "9007199254740995", "2.2250738585072011e-308", "2.2250738585072014e-308", "4.9406564584124654e-324",
+        "2.4703282292062327e-324", "2.4703282292062328e-324", "1.7976931348623157e308", "1.7976931348623158e308", "1.7976931348623159e308",
+        "0.1000000000000000055511151231257827021181583404541015625", "0.1000000000000000055511151231257827021181583404541015626",
+        "0.1000000000000000055511151231257827021181583404541015624", "123456789012345678901234567890e-10", "0.000000000000000000000000000001",
+        "3.4028235677973366e38", "1.4012984643e-45", "7.0064923216e-46", "1.00000005960464477539062500001", "16777217", "16777216.999999999999999999999"
+    };
+    char* e;
+    char buffer[32];
+    for (const char* s : edge) {
+        assert(strtod_fast(s, &e) == strtod(s, 0) && *e == 0, "%s", s);
+        assert(strtof_fast(s, &e) == strtof(s, 0) && *e == 0, "%s", s);
+    }
 
-FUNCTION(bool, aligned,(void* p, unsigned int m), "Whether the pointer is aligned by the given size") {
-    return divisible((unsigned long long) p, m);
+    uint64_t r = 1;
+    for (int i = 0; i < 100000; i++) {
+        _testRandom(r);
+        double x;
+        memcpy(&x, &r, sizeof(x));
+        if (!isfinite(x)) continue;
+        if (i % 2) dtostr_fast(x, 1 + i % 17, buffer, &e);
+        else dtostr_shortest_fast(x, 17, buffer, &e);
+        *e = 0;
+        const double y = strtod_fast(buffer, &e), z = strtod(buffer, 0);
+        assert(memcmp(&y, &z, sizeof(y)) == 0 && *e == 0, "%s", buffer);
+        assert(i % 2 || y == x, "%s", buffer);
+        assert(strtof_fast(buffer, &e) == strtof(buffer, 0), "%s", buffer);
+    }
 }
 
-TEST(aligned1) {
-    assert(aligned((void*)0x4, 4u));
-    assert(!aligned((void*)0x8, 6u));
-    assert(aligned((void*)0x8, 8u));
+// the rare inputs parsed by the C library do not depend on the locale, e.g. one with ',' as decimal point
+TEST_SERIAL(strtod_fast_locale1) {
+    const char* const tie = "9007199254740993.0000000000000000001"; // just above halfway between 2^53 and 2^53 + 2
+    char* e;
+    assert(strtod_fast(tie, &e) == 9007199254740994. && *e == 0);
+    const string previous = setlocale(LC_NUMERIC, 0);
+    for (const char* const name : {"de_DE.UTF-8", "de_DE.utf8", "de_DE", "fr_FR.UTF-8", "German_Germany"}) {
+        if (!setlocale(LC_NUMERIC, name)) continue; // not installed
+        const double x = strtod_fast(tie, &e);
+        const float f = strtof_fast("16777217.0000000000000000001", &e); // just above halfway between 2^24 and 2^24 + 2
+        setlocale(LC_NUMERIC, previous.c_str());
+        assert(x == 9007199254740994. && f == 16777218.f, "in %s", name);
+        break;
+    }
 }
 
-FUNCTION(bool, after, (void* a, void* b), "C57") {
-    return (unsigned long long)a >= (unsigned long long)b;
+// nothing is read past the terminating 0: each input is alone in an allocation of its exact size, for AddressSanitizer to check
+TEST(strtod_fast_terminator1) {
+    const char* const inputs[] = {"90.09", "7", "-12345678901234567890", "123456789012", "0.00000123456789", "1e5", "18446744073709551616",
+        "0x1.8p1", "-0x1.921fb54442d18p+0001", "0xabcdef0123"};
+    for (const char* const input : inputs) {
+        const vector<char> copy(input, input + strlen(input) + 1);
+        char* e;
+        if (strchr(input, 'x')) {
+            assert(hextod_fast(copy.data(), &e) == strtod(input, 0) && !*e, "%s", input);
+            assert(hextof_fast(copy.data(), &e) == strtof(input, 0) && !*e, "%s", input);
+            continue;
+        }
+        assert(strtod_fast(copy.data(), &e) == strtod(input, 0) && !*e, "%s", input);
+        assert(strtof_fast(copy.data(), &e) == strtof(input, 0) && !*e, "%s", input);
+        if (strpbrk(input, ".e")) continue;
+        const long long i = strtoll(input, 0, 10);
+        assert(strtoi64_fast(copy.data(), &e) == i && !*e, "%s", input);
+        if (input[0] != '-') assert(strtou64_fast(copy.data(), &e) == strtoull(input, 0, 10) && !*e, "%s", input);
+    }
 }
 
-FUNCTION(bool, strictly_after, (void* a, void* b), "C58", PURITY_PURE) {
-    return (unsigned long long)a > (unsigned long long)b;
+TEST(u64tostr_fast1) {
+    char b[32], c[32];
+    char* e;
+    const uint64_t edge[] = {0, 1, 9, 10, 99, 100, 4294967295ull, 4294967296ull, 9999999999999999999ull, 10000000000000000000ull, 18446744073709551615ull};
+    for (const uint64_t x : edge) {
+        u64tostr_fast(x, b, &e);
+        assert((size_t)(e - b) == (size_t)snprintf(c, sizeof(c), "%llu", (unsigned long long)x) && !memcmp(b, c, e - b), "%llu", (unsigned long long)x);
+        assert(decimal_digits_u64(x) == e - b);
+    }
+
+    uint64_t r = 1;
+    for (int i = 0; i < 10000; i++) {
+        _testRandom(r);
+        const uint64_t x = r >> (i % 64);
+        i64tostr_fast((int64_t)x, b, &e);
+        assert((size_t)(e - b) == (size_t)snprintf(c, sizeof(c), "%lld", (long long)x) && !memcmp(b, c, e - b));
+        i32tostr_fast((int32_t)x, b, &e);
+        assert((size_t)(e - b) == (size_t)snprintf(c, sizeof(c), "%d", (int32_t)x) && !memcmp(b, c, e - b));
+        u32tostr_fast((uint32_t)x, b, &e);
+        assert((size_t)(e - b) == (size_t)snprintf(c, sizeof(c), "%u", (uint32_t)x) && !memcmp(b, c, e - b));
+    }
+
+    u32tostr_fast_fixed(42, 5, b, &e);
+    assert(e == b + 5 && !memcmp(b, "00042", 5));
+    u64tostr_fast_fixed(123456, 3, b, &e);
+    assert(e == b + 3 && !memcmp(b, "456", 3));
+    i64tostr_fast_fixed(INT64_MIN, 19, b, &e);
+    assert(e == b + 20 && !memcmp(b, "-9223372036854775808", 20));
+    i32tostr_fast_fixed(7, 3, b, &e);
+    assert(e == b + 4 && !memcmp(b, "+007", 4));
+
+    itoa_backwards_signed(3, -20, b + 3);
+    assert(!memcmp(b, "-020", 4));
+    ulltoa_backwards_dotted(4, 1234, b + 4);
+    assert(!memcmp(b, "1.234", 5));
+    ulltoa_backwards_dotted(22, 1234, b + 22); // more digits than any long long has
+    assert(!memcmp(b, "0.000000000000000001234", 23));
+    ulltoa_backwards_dotted(1, 7, b + 1);
+    assert(!memcmp(b, "7.", 2));
 }
 
-FUNCTION(unsigned int, mod, (int n, unsigned int m), "mod(n, m) Mathematical mod function, returning positive values such that n = x*m + mod(n, m) for some x"
-    "TODO extend, along with floor and ceil and mod to be more general (floor and ceil require < too...)", PURITY_PURE) {
-    return ((n % m) + m) % m; // TODO could this lead to an overflow for large m? Restrict the range of m?
+TEST_SERIAL(verify_conversions1) {
+    assert(verify_conversions(20000, false, false) == 0);
 }
 
-TEST(mod1) {
-    assert(mod(-2, 4) == 2);
-    assert(mod(2, 4) == 2);
-    assert(mod(2, 2) == 0);
+TEST(strtod_fast_batch1) {
+    const char s[] = " 1.5,-2.25\n3,,0.125 9\r\n100000000000000000000000 x";
+    double out[10];
+    char* e;
+    const size_t n = strtod_fast_batch(s, s + sizeof(s) - 1, ',', out, 10, &e);
+    assert(n == 6);
+    assert(out[0] == 1.5 && out[1] == -2.25 && out[2] == 3. && out[3] == 0.125 && out[4] == 9. && out[5] == 1e23);
+    assert(*e == 'x');
+
+    float f[2];
+    assert(strtof_fast_batch(s, s + sizeof(s) - 1, ',', f, 2, &e) == 2);
+    assert(f[0] == 1.5f && f[1] == -2.25f);
+
+    const char t[] = "1e3 +2.5E-1,0.1000000000000000055511151231257827021181583404541015626";
+    assert(strtod_fast_batch(t, t + sizeof(t) - 1, ',', out, 10, &e) == 3);
+    assert(out[0] == 1e3 && out[1] == 0.25 && out[2] == 0.1 && e == t + sizeof(t) - 1);
 }
 
-FUNCTION(int, nextEven, (int i), "C101 Gives the next even signed (two's complement) leint32, i.e. i if this is even, i+1 otherwise. Undefined for 2^31-1. TODO generalize this in a generalized ceil, c.f. Mathematica.", PURITY_PURE) {
-    assert(i != INT_MAX);
-    if (i % 2 == 0) return i;
-    return i + 1;
+TEST_SERIAL(strtod_fast_file1) {
+    const char* const path = "strtod_fast_file1.txt";
+    FILE* f = fopen(path, "wb");
+    assert(f);
+    DO(i, 300000) fprintf(f, i % 3 == 2 ? "%u.5\n" : "%u.5,", i);
+    fclose(f);
+
+    UninitializedVector<float> out;
+    bool ok = strtof_fast_file(path, ',', out, 4);
+    assert(ok && out.size() == 300000);
+    DO(i, out.size()) assert(out[i] == i + 0.5f);
+
+    UninitializedVector<double> outd;
+    ok = strtod_fast_file(path, ',', outd, 1);
+    assert(ok && outd.size() == 300000 && outd[299999] == 299999.5);
+
+    // a single line, which is split at the commas
+    f = fopen(path, "wb");
+    assert(f);
+    DO(i, 300000) fprintf(f, "%u.25,", i);
+    fclose(f);
+    ok = strtod_fast_file(path, ',', outd, 4);
+    assert(ok && outd.size() == 300000);
+    DO(i, outd.size()) assert(outd[i] == i + 0.25);
+    remove(path);
+
+    ok = strtod_fast_file(path, ',', outd);
+    assert(!ok);
 }
 
+TEST_SERIAL(dtostr_fast_array1) {
+    const size_t n = 100000;
+    vector<double> values(n);
+    DO(i, n) values[i] = i * -0.25;
+    vector<char> s(dtostr_fast_array_length(n, 5) + 1);
+    char* e;
+    dtostr_fast_array(values.data(), n, 5, ',', 3, s.data(), &e, 4);
+    assert(e == s.data() + dtostr_fast_array_length(n, 5));
+
+    char b[32];
+    FOR1(size_t, i, n - 10, n) {
+        char* const v = s.data() + i * 13;
+        dtostr_fast(values[i], 5, b, &e);
+        assert(!memcmp(v, b, 12));
+        assert(v[12] == (i % 3 == 2 || i == n - 1 ? '\n' : ','));
+    }
 
-// TODO better device implementation
-FUNCTION(float, assertFinite, (float value)
-    , "C56: The function that is the identity for finite single-precision (32 bit little endian) floating point values and undefined otherwise") {
-#ifdef _DEBUG
-#if GPU_CODE
-    assert(1.f * value == value);
-#else
-    assert(_fpclass(value) == _FPCLASS_PD || _fpclass(value) == _FPCLASS_PN || _fpclass(value) == _FPCLASS_PZ ||
-        _fpclass(value) == _FPCLASS_ND || _fpclass(value) == _FPCLASS_NN || _fpclass(value) == _FPCLASS_NZ);
-        //, "value = %f is not finite", value);
-#endif
-#endif
-    return value;
+    float f[2] = {1.f, 2.f};
+    ftostr_fast_array(f, 2, 3, ' ', 0, b, &e);
+    assert(e == b + 22 && b[10] == ' ' && b[21] == '\n');
 }
 
+/*
+writes to files at given offsets, so that several writes can be in flight without a shared file position.
+file_create creates or truncates path, returning -1 if that fails. The file is closed with file_close.
+*/
+intptr_t file_create(const char* path);
+bool file_write_at(intptr_t file, const void* data, size_t bytes, uint64_t offset);
+bool file_close(intptr_t file);
 
-template<typename In, typename Out>
-CPU_FUNCTION(
-    bool
-    ,definedQ
-    ,(_In_ const unordered_map<In, Out>& f, _In_ const In& in, _Out_opt_ Out& out)
-    ,"false if f is not defined for in.\
-    out is undefined in that case\
-    true and out is f[in] otherwise\
-    In and Out must be valid unordered_map parameters."
-    ,PURITY_OUTPUT_POINTERS
-    )
-    {
-    auto outi = f.find(in);
-    if (f.end() == outi) return false;
-    out = outi->second;
-    return true;
-}
+/*
+a minimal io_uring (Linux 5.6+) for writes: uring_write submits a write of up to 1 GiB, uring_wait returns the tag and
+result (bytes written or -errno) of one completed write, waiting for one if needed. Only one thread may use a ring.
+uring_write returns false only if the ring is full, nothing is queued then. A queued write is always completed by uring_wait,
+writes the kernel did not accept at once are submitted again by the next call; uring_wait fails if that is impossible.
+uring_create returns 0 where io_uring is not available
+*/
+void* uring_create(unsigned int entries);
+bool uring_write(void* ring, intptr_t file, const void* data, size_t bytes, uint64_t offset, uint64_t tag);
+bool uring_wait(void* ring, uint64_t* tag, int64_t* result);
+void uring_destroy(void* ring);
+
+enum AsyncWriterMode {
+    ASYNC_WRITER_AUTO, // io_uring if available, else a thread
+    ASYNC_WRITER_URING, // buffers are written by the kernel while the caller continues
+    ASYNC_WRITER_THREAD, // buffers are written by a background thread
+    ASYNC_WRITER_SYNC // buffers are written by the caller when full
+};
+
+struct AsyncWriterStatistics {
+    uint64_t bytes; // written to the file
+    uint64_t writes; // of buffers
+    uint64_t stalls; // times the caller had to wait for a buffer to be written (backpressure)
+    double stall_seconds;
+    double write_seconds; // from submission to completion of each write, summed
+    double max_write_seconds;
+};
 
-template<typename In, typename Out>
-CPU_FUNCTION(
-    bool
-    ,definedQ
-    ,(_In_ const unordered_map<In, Out>& f, _In_ const In& in)
-    ,"true iff f is defined for in.\
-    In and Out must be valid unordered_map parameters."
-    ,PURITY_PURE) {
-    auto outi = f.find(in);
-    if (f.end() == outi) return false;
-    return true;
-}
+/*
+Writes text to a file while the caller formats more: the caller fills one of several fixed size buffers,
+full buffers are written in the background (see AsyncWriterMode). When all buffers are being written, the caller waits.
+e.g.
+AsyncTextWriter w;
+if (!w.open("out.txt")) ...
+DO(i, n) w.writeDouble(values[i], 17, '\n');
+if (!w.close()) ...
+
+Errors are sticky: once a write fails, flush and close return false.
+*/
+class AsyncTextWriter {
+    struct Buffer {
+        vector<char> data;
+        size_t size = 0;
+        uint64_t offset = 0; // in the file
+        chrono::steady_clock::time_point submitted;
+    };
+
+    intptr_t file = -1;
+    AsyncWriterMode mode = ASYNC_WRITER_SYNC;
+    void* ring = 0;
+    vector<Buffer> buffers;
+    size_t current = SIZE_MAX; // being filled
+    uint64_t offset = 0; // of the next buffer submitted
+    size_t in_flight = 0;
+    bool ring_broken = false; // uring_wait failed: the writes in flight may never complete, their buffers stay untouched
+
+    // shared with the background thread
+    thread writer;
+    mutex m;
+    condition_variable work, done;
+    deque<size_t> queue;
+    vector<size_t> free_buffers;
+    bool stopping = false, failed = false;
+    AsyncWriterStatistics stats = {};
+
+    CPU_MEMBERFUNCTION(void, completed, (size_t i, bool ok), "Returns buffer i after its write, with m held", PURITY_OUTPUT_POINTERS) {
+        const double seconds = chrono::duration<double>(chrono::steady_clock::now() - buffers[i].submitted).count();
+        stats.writes++;
+        stats.bytes += ok ? buffers[i].size : 0;
+        stats.write_seconds += seconds;
+        stats.max_write_seconds = max(stats.max_write_seconds, seconds);
+        failed |= !ok;
+        buffers[i].size = 0;
+        free_buffers.push_back(i);
+        in_flight--;
+    }
 
+    CPU_MEMBERFUNCTION(void, reap, (), "Waits for one io_uring write to complete", PURITY_OUTPUT_POINTERS) {
+        uint64_t i;
+        int64_t result;
+        if (!uring_wait(ring, &i, &result)) {
+            // no more completions: later writes fail, and a fresh buffer takes the place of those the kernel may still read
+            failed = ring_broken = true;
+            if (free_buffers.empty()) {
+                buffers.emplace_back(); // moving the others keeps their data where it is
+                buffers.back().data.resize(buffers[0].data.size());
+                free_buffers.push_back(buffers.size() - 1);
+            }
+            return;
+        }
+        Buffer& b = buffers[i];
+        // short writes are rare (e.g. a full disk), finish them right here
+        const bool ok = result >= 0 && file_write_at(file, b.data.data() + result, b.size - (size_t)result, b.offset + (uint64_t)result);
+        completed((size_t)i, ok);
+    }
 
+    CPU_MEMBERFUNCTION(void, submit, (), "Starts writing the current buffer", PURITY_OUTPUT_POINTERS) {
+        Buffer& b = buffers[current];
+        b.offset = offset;
+        offset += b.size;
+        b.submitted = chrono::steady_clock::now();
+        const size_t i = current;
+        current = SIZE_MAX;
+        if (mode == ASYNC_WRITER_THREAD) {
+            lock_guard<mutex> lock(m);
+            in_flight++;
+            queue.push_back(i);
+            work.notify_one();
+            return;
+        }
+        in_flight++;
+        if (ring_broken) completed(i, false);
+        else if (mode == ASYNC_WRITER_SYNC) completed(i, file_write_at(file, b.data.data(), b.size, b.offset));
+        else if (!uring_write(ring, file, b.data.data(), b.size, b.offset, i)) completed(i, file_write_at(file, b.data.data(), b.size, b.offset));
+    }
 
-FUNCTION(unsigned int, highest_bit_position, (unsigned int x), "C199", PURITY_PURE) {
-    assert(x);
-    unsigned int p = 0;
-    unsigned int cp = 16;
-    unsigned int c = 1 << cp;
-    for (; cp; ((cp /= 2), (c = 1 << cp))) {
-        if (x >= c) {
-            p += cp;
-            x >>= cp;
+    CPU_MEMBERFUNCTION(void, acquire, (), "Makes a free buffer current, waiting for one if there is none", PURITY_OUTPUT_POINTERS) {
+        unique_lock<mutex> lock(m, defer_lock);
+        if (mode == ASYNC_WRITER_THREAD) lock.lock();
+        if (free_buffers.empty()) {
+            const auto start = chrono::steady_clock::now();
+            if (mode == ASYNC_WRITER_THREAD) done.wait(lock, [&]() { return !free_buffers.empty(); });
+            else reap();
+            stats.stalls++;
+            stats.stall_seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
         }
+        current = free_buffers.back();
+        free_buffers.pop_back();
     }
+
+    CPU_MEMBERFUNCTION(void, background, (), "The background thread of ASYNC_WRITER_THREAD", PURITY_OUTPUT_POINTERS) {
+        unique_lock<mutex> lock(m);
+        for (;;) {
+            work.wait(lock, [&]() { return stopping || !queue.empty(); });
+            if (queue.empty()) return;
+            const size_t i = queue.front();
+            queue.pop_front();
+            lock.unlock();
+            const bool ok = file_write_at(file, buffers[i].data.data(), buffers[i].size, buffers[i].offset);
+            lock.lock();
+            completed(i, ok);
+            done.notify_all();
+        }
+    }
+
+public:
+    AsyncTextWriter() {}
+    AsyncTextWriter(const AsyncTextWriter&) = delete;
+    AsyncTextWriter& operator=(const AsyncTextWriter&) = delete;
+    ~AsyncTextWriter() { close(); }
+
+    /*
+    creates or truncates the file at path, to be written through buffer_count buffers of buffer_bytes each.
+    false if the file cannot be created, or mode is ASYNC_WRITER_URING and io_uring is not available
+    */
+    CPU_MEMBERFUNCTION(bool, open, (_In_z_ const char* path, AsyncWriterMode mode = ASYNC_WRITER_AUTO, size_t buffer_bytes = 1 << 20, size_t buffer_count = 4), "", PURITY_ENVIRONMENT_DEPENDENT) {
+        close();
+        assert(buffer_bytes >= 64 && buffer_count >= 2);
+        if (mode == ASYNC_WRITER_AUTO || mode == ASYNC_WRITER_URING) {
+            ring = uring_create((unsigned int)buffer_count);
+            if (!ring && mode == ASYNC_WRITER_URING) return false;
+            mode = ring ? ASYNC_WRITER_URING : ASYNC_WRITER_THREAD;
+        }
+        file = file_create(path);
+        if (file < 0) {
+            uring_destroy(ring);
+            ring = 0;
+            return false;
+        }
+        this->mode = mode;
+        buffers = vector<Buffer>(buffer_count);
+        for (auto& b : buffers) b.data.resize(buffer_bytes);
+        free_buffers.clear();
+        for (size_t i = buffer_count; i-- > 1;) free_buffers.push_back(i);
+        current = 0;
+        offset = 0;
+        in_flight = 0;
+        ring_broken = stopping = failed = false;
+        stats = AsyncWriterStatistics();
+        if (mode == ASYNC_WRITER_THREAD) writer = thread([this]() { background(); });
+        return true;
+    }
+
+    CPU_MEMBERFUNCTION(AsyncWriterMode, getMode, () const, "How buffers are written, never ASYNC_WRITER_AUTO once open", PURITY_PURE) {
+        return mode;
+    }
+
+    /*
+    room for n characters (at most the buffer size) to be formatted into, followed by commit(end of what was written).
+    e.g. char* e; u64tostr_fast(x, w.reserve(20), &e); w.commit(e);
+    */
+    CPU_MEMBERFUNCTION(char*, reserve, (size_t n), "", PURITY_OUTPUT_POINTERS) {
+        assert(file >= 0 && n <= buffers[0].data.size(), "%zu characters do not fit in a buffer", n);
+        if (buffers[current].size + n > buffers[current].data.size()) {
+            submit();
+            acquire();
+        }
+        return buffers[current].data.data() + buffers[current].size;
+    }
+
+    CPU_MEMBERFUNCTION(void, commit, (char* end), "Adds the characters up to end to the file, see reserve", PURITY_OUTPUT_POINTERS) {
+        Buffer& b = buffers[current];
+        assert(end >= b.data.data() + b.size && end <= b.data.data() + b.data.size());
+        b.size = end - b.data.data();
+    }
+
+    CPU_MEMBERFUNCTION(void, write, (_In_reads_(n) const char* s, size_t n), "Writes n characters", PURITY_OUTPUT_POINTERS) {
+        while (n) {
+            const size_t k = min(n, buffers[0].data.size());
+            char* const p = reserve(k);
+            memcpy(p, s, k);
+            commit(p + k);
+            s += k, n -= k;
+        }
+    }
+
+    CPU_MEMBERFUNCTION(void, writeDouble, (double value, int digits, char sep), "Writes value with dtostr_fast, followed by sep", PURITY_OUTPUT_POINTERS) {
+        char* e;
+        dtostr_fast(value, digits, reserve(digits + dtostr_fast_extra_chars + 1), &e);
+        *e++ = sep;
+        commit(e);
+    }
+
+    CPU_MEMBERFUNCTION(void, writeFloat, (float value, int digits, char sep), "Writes value with ftostr_fast, followed by sep", PURITY_OUTPUT_POINTERS) {
+        char* e;
+        ftostr_fast(value, digits, reserve(digits + dtostr_fast_extra_chars + 1), &e);
+        *e++ = sep;
+        commit(e);
+    }
+
+    CPU_MEMBERFUNCTION(void, writeInt, (int64_t value, char sep), "Writes value with i64tostr_fast, followed by sep", PURITY_OUTPUT_POINTERS) {
+        char* e;
+        i64tostr_fast(value, reserve(21), &e);
+        *e++ = sep;
+        commit(e);
+    }
+
+    CPU_MEMBERFUNCTION(bool, flush, (), "Writes everything so far and waits for it. Returns false if any write failed.", PURITY_OUTPUT_POINTERS) {
+        if (file < 0) return false;
+        if (buffers[current].size) {
+            submit();
+            acquire();
+        }
+        if (mode == ASYNC_WRITER_THREAD) {
+            unique_lock<mutex> lock(m);
+            done.wait(lock, [&]() { return !in_flight; });
+        }
+        else while (in_flight && !ring_broken) reap(); // all completions, even after a failed write
+        lock_guard<mutex> lock(m);
+        return !failed;
+    }
+
+    CPU_MEMBERFUNCTION(bool, close, (), "Flushes and closes the file. Returns false if anything failed.", PURITY_OUTPUT_POINTERS) {
+        if (file < 0) return false;
+        bool ok = flush();
+        if (writer.joinable()) {
+            {
+                lock_guard<mutex> lock(m);
+                stopping = true;
+            }
+            work.notify_one();
+            writer.join();
+        }
+        if (ring_broken && in_flight) new vector<Buffer>(move(buffers)); // leaked with the ring, which the kernel may still write from
+        else uring_destroy(ring);
+        ring = 0;
+        ok = file_close(file) && ok;
+        file = -1;
+        return ok;
+    }
+
+    CPU_MEMBERFUNCTION(AsyncWriterStatistics, statistics, (), "The counters since open", PURITY_ENVIRONMENT_DEPENDENT) {
+        lock_guard<mutex> lock(m);
+        return stats;
+    }
+};
+
+TEST_SERIAL(asyncTextWriter1) {
+    const char* const path = "asyncTextWriter1.txt";
+    const size_t n = 100000;
+    string text(10000, 'x'); // larger than the buffers
+    for (const AsyncWriterMode mode : {ASYNC_WRITER_SYNC, ASYNC_WRITER_THREAD, ASYNC_WRITER_URING, ASYNC_WRITER_AUTO}) {
+        AsyncTextWriter w;
+        if (!w.open(path, mode, 4096, 3)) {
+            assert(mode == ASYNC_WRITER_URING, "cannot create %s", path); // io_uring may be unavailable
+            continue;
+        }
+        assert(w.getMode() != ASYNC_WRITER_AUTO);
+        DO(i, n) {
+            w.writeDouble(i * 0.5, 6, ',');
+            w.writeInt(-(int64_t)i, '\n');
+            if (i == n / 2) {
+                w.write(text.data(), text.size());
+                const bool flushed = w.flush();
+                assert(flushed);
+            }
+        }
+        const bool closed = w.close();
+        assert(closed);
+        const AsyncWriterStatistics s = w.statistics();
+        assert(s.writes >= s.bytes / 4096 && s.write_seconds >= s.max_write_seconds);
+
+        size_t size;
+        const char* const data = map_file(path, &size);
+        assert(data && size == s.bytes, "%zu of %llu bytes in mode %d", size, (unsigned long long)s.bytes, (int)mode);
+        const char* p = data;
+        DO(i, n) {
+            char* e;
+            assert(strtod_fast(p, &e) == i * 0.5 && *e == ',');
+            assert(strtoi64_fast(e + 1, &e) == -(int64_t)i && *e == '\n');
+            p = e + 1;
+            if (i == n / 2) {
+                assert(!memcmp(p, text.data(), text.size()));
+                p += text.size();
+            }
+        }
+        assert(p == data + size);
+        unmap_file(data, size);
+    }
+    remove(path);
+}
+
+TEST(dtostr_shortest_fast1) {
+    char b[64];
+    char* e;
+    dtostr_shortest_fast(1e22, 17, b, &e);
+    assert(e == b + 24 && !memcmp(b, "+1.0000000000000000e+022", 24));
+    dtostr_shortest_fast(-0.1, 3, b, &e);
+    assert(e == b + 10 && !memcmp(b, "-1.00e-001", 10));
+    dtostr_shortest_fast(9.9999, 3, b, &e);
+    assert(!memcmp(b, "+1.00e+001", 10));
+    dtostr_shortest_fast(0., 3, b, &e);
+    assert(!memcmp(b, "+0.00e+000", 10));
+    dtostr_shortest_fast(5e-324, 17, b, &e);
+    assert(!memcmp(b, "+5.0000000000000000e-324", 24));
+    dtostr_shortest_fast(INFINITY, 3, b, &e);
+    assert(e == b + 10 && !memcmp(b, "+inf      ", 10));
+    ftostr_shortest_fast(0.3f, 9, b, &e);
+    assert(e == b + 16 && !memcmp(b, "+3.00000000e-001", 16));
+
+    // fewer digits round the value, not its shortest digits: 1.005 is 1.00499999999999989...
+    dtostr_shortest_fast(1.005, 3, b, &e);
+    assert(!memcmp(b, "+1.00e+000", 10));
+    dtostr_shortest_fast(0.125, 2, b, &e);
+    assert(!memcmp(b, "+1.2e-001", 9));
+    dtostr_shortest_fast(0.375, 2, b, &e);
+    assert(!memcmp(b, "+3.8e-001", 9));
+    dtostr_shortest_fast(9.96, 2, b, &e);
+    assert(!memcmp(b, "+1.0e+001", 9));
+
+    // round trip, and agreement with printf when fewer digits than the shortest ones are written
+    uint64_t bits = 0x123456789abcdefull;
+    char c[64];
+    REPEAT(100000) {
+        _testRandom(bits);
+        double v;
+        memcpy(&v, &bits, 8);
+        if (!isfinite(v)) continue;
+        dtostr_shortest_fast(v, 17, b, &e);
+        *e = 0;
+        assert(strtod(b, 0) == v);
+        int shortest = 17; // digits, the rest of the 17 are padding
+        while (shortest > 1 && b[shortest + 1] == '0') shortest--;
+        const int digits = 1 + (int)(bits >> 60);
+        dtostr_shortest_fast(v, digits, b, &e);
+        *e = 0;
+        snprintf(c, sizeof(c), "%#+.*e", digits - 1, v); // # keeps the . of 1 digit
+        assert(digits >= shortest || (!memcmp(b, c, digits + 2) && atoi(b + digits + 3) == atoi(strchr(c, 'e') + 1)), "%s %s", b, c);
+
+        float f;
+        memcpy(&f, &bits, 4);
+        if (!isfinite(f)) continue;
+        ftostr_shortest_fast(f, 9, b, &e);
+        *e = 0;
+        assert(strtof(b, 0) == f);
+    }
+}
+
+TEST(dtohex_fast1) {
+    char b[64], c[64];
+    char* e;
+    dtohex_fast(1.5, b, &e);
+    assert(e == b + dtohex_fast_chars && !memcmp(b, "+0x1.8000000000000p+0000", 24));
+    dtohex_fast(-5e-324, b, &e);
+    assert(!memcmp(b, "-0x0.0000000000001p-1022", 24));
+    dtohex_fast(0., b, &e);
+    assert(!memcmp(b, "+0x0.0000000000000p+0000", 24));
+    dtohex_fast(-INFINITY, b, &e);
+    assert(e == b + 24 && !memcmp(b, "-inf                    ", 24));
+    ftohex_fast(0.1f, b, &e);
+    assert(e == b + ftohex_fast_chars && !memcmp(b, "+0x1.99999ap-004", 16));
+    ftohex_fast(-FLT_MAX, b, &e);
+    assert(!memcmp(b, "-0x1.fffffep+127", 16));
+
+    // rounding of digits beyond the precision, ties to even
+    assert(hextod_fast("0x1.00000000000008p0", &e) == 1. && !*e);
+    assert(hextod_fast("0x1.00000000000018p0", &e) == 1. + 2 * DBL_EPSILON);
+    assert(hextod_fast("0x1.000000000000080000000000000001p0", &e) == 1. + DBL_EPSILON);
+    assert(hextod_fast("0x0.00000000000008p-1022", &e) == 0. && hextod_fast("0x0.00000000000018p-1022", &e) == 2 * 5e-324);
+    assert(hextod_fast("0x1.fffffffffffff8p1023", &e) == INFINITY && hextod_fast("-0x1p-1080", &e) == 0. && signbit(hextod_fast("-0x1p-1080", &e)));
+    assert(hextod_fast("0x.8", &e) == 0.5 && hextod_fast("-0XAp-1", &e) == -5. && hextod_fast("0x10", &e) == 16. && !*e);
+    assert(hextof_fast("0x1.000001p0", &e) == 1.f && hextof_fast("0x1.000003p0", &e) == 1.f + 2 * FLT_EPSILON);
+    assert(isnan(hextod_fast("-nan", &e)) && hextod_fast("inf", &e) == INFINITY);
+    const char* const bad = "0xp1";
+    assert(hextod_fast(bad, &e) == 0 && e == bad);
+
+    // exact round trip, and the same values as printf and strtod
+    uint64_t bits = 0x123456789abcdefull;
+    REPEAT(100000) {
+        _testRandom(bits);
+        double v;
+        memcpy(&v, &bits, 8);
+        dtohex_fast(v, b, &e);
+        *e = 0;
+        const double w = hextod_fast(b, &e);
+        assert((!*e || !isfinite(v)) && (memcmp(&v, &w, 8) == 0 || (isnan(v) && isnan(w))), "%s", b); // inf and nan are padded
+        if (isfinite(v)) {
+            snprintf(c, sizeof(c), "%+.13a", v);
+            assert(!memcmp(b, c, 19) && atoi(b + 19) == atoi(c + 19), "%s %s", b, c);
+        }
+
+        float f;
+        memcpy(&f, &bits, 4);
+        ftohex_fast(f, b, &e);
+        *e = 0;
+        const float g = hextof_fast(b, &e);
+        assert((!*e || !isfinite(f)) && (memcmp(&f, &g, 4) == 0 || (isnan(f) && isnan(g))), "%s", b);
+
+        // up to 16 random digits and any exponent, against one rounding of the exact long double (glibc's strtod misrounds some subnormals)
+        if (LDBL_MANT_DIG < 64) continue;
+        const int digits = 1 + (int)(bits >> 60), exponent = (int)(bits >> 40 & 2047) - 1100;
+        const unsigned long long m = digits == 16 ? bits : bits & ((1ull << (4 * digits)) - 1);
+        snprintf(c, sizeof(c), "%s0x%0*llxp%d", bits & 1 ? "-" : "", digits, m, exponent);
+        const long double exact = (bits & 1 ? -1 : 1) * ldexpl((long double)m, exponent);
+        assert(hextod_fast(c, &e) == (double)exact && !*e, "%s", c);
+        assert(hextof_fast(c, &e) == (float)exact, "%s", c);
+    }
+
+    // arrays
+    const double values[] = {1., -0.1, 5e-324, INFINITY, DBL_MAX};
+    vector<char> text(5 * (dtohex_fast_chars + 1));
+    dtohex_fast_array(values, 5, ',', 2, text.data(), &e, 0);
+    assert(e == text.data() + text.size() && text[24] == ',' && text[49] == '\n' && text.back() == '\n');
+    double parsed[5];
+    assert(hextod_fast_batch(text.data(), e, ',', parsed, 5, &e) == 5 && e == text.data() + text.size() && !memcmp(parsed, values, sizeof(values)));
+    const float fvalues[] = {1.f, -0.1f, FLT_MIN};
+    text.resize(3 * (ftohex_fast_chars + 1));
+    ftohex_fast_array(fvalues, 3, ' ', 0, text.data(), &e, 0);
+    float fparsed[3];
+    assert(hextof_fast_batch(text.data(), e, ' ', fparsed, 3, &e) == 3 && !memcmp(fparsed, fvalues, sizeof(fvalues)));
+}
+
+TEST_SERIAL(parallel_do1) {
+    const unsigned int n = 100000;
+    vector<atomic<int>> visits(n);
+    PARALLEL_DO(i, n) {
+        visits[i]++;
+    }
+    PARALLEL_DO_SCHEDULE((dynamic, 100), i, n) {
+        visits[i]++;
+    }
+    PARALLEL_FOR_SCHEDULE((guided, 10), int, i, -5, (int)n - 5, 1) {
+        visits[i + 5]++;
+    }
+    PARALLEL_FOR(size_t, i, 1, n, 2) {
+        visits[i]++;
+    }
+    DO(i, n) assert(visits[i] == 3 + (int)(i % 2));
+
+    vector<int> a(n, 1);
+    PARALLEL_FOREACH(x, a, n) x += (int)i;
+    atomic<long long> sum(0);
+    PARALLEL_FOREACHC(x, a, n) sum += x;
+    assert(sum == (long long)n + (long long)n * (n - 1) / 2);
+}
+
+// the options of runBenchmarks, with a filter that selects no benchmark
+TEST(runBenchmarks1) {
+    auto run = [](const char* option) {
+        const char* args[] = {"runBenchmarks1", "runBenchmarks1_none", option};
+        return runBenchmarks(3, (char**)args);
+    };
+    const int regressions = run("--threshold=0.2");
+    assert(regressions == 0);
+    for (const char* const option : {"--treshold=0.2", "--threshold=abc", "--threshold=-1", "--baseline=runBenchmarks1_missing.txt",
+        "--save=runBenchmarks1_missing_directory/baseline.txt"}) {
+        bool rejected = false;
+        try {
+            run(option);
+        }
+        catch (const test_failure&) {
+            rejected = true;
+        }
+        assert(rejected, "%s", option);
+    }
+}
+
+TEST(benchmarkStatistics1) {
+    vector<double> ns;
+    DO1(i, 100) ns.push_back(101 - i);
+    const BenchmarkStatistics s = _benchmarkStatistics(ns, ns);
+    assert(s.median == 51 && s.p99 == 99 && s.mean == 50.5 && s.cycles == 51);
+    assert(fabs(s.stddev - sqrt((100 * 100 - 1) / 12.)) < 1e-9);
+}
+
+// Tests for runTests itself: runTests1 runs the runnerSample tests, which fail only while it does so
+bool _runnerSelfTest = false;
+
+TEST(runnerSample_pass) {}
+
+TEST(runnerSample_fail) {
+    assert(!_runnerSelfTest, "fails \"on purpose\"\n\tin\\runnerSample_fail\x01");
+}
+
+TEST(runnerSample_parallelFail) {
+    PARALLEL_DO(i, 1000) assert(!_runnerSelfTest || i != 500, "fails on purpose in iteration %u", (unsigned int)i);
+}
+
+TEST_SERIAL(runTests1) {
+    assert(_jsonEscape("a\"b\\c\nd\x01\x1f") == "a\\\"b\\\\c\\nd\\u0001\\u001f");
+    assert(_selectedByFilters("strtod_fast1", {}, {}));
+    assert(_selectedByFilters("strtod_fast1", {"dtostr", "strtod"}, {}));
+    assert(!_selectedByFilters("strtod_fast1", {"dtostr"}, {}));
+    assert(!_selectedByFilters("strtod_fast1", {"strtod"}, {"fast1"}));
+
+    const char* const path = "runTests1.json";
+    auto run = [&](vector<const char*> args) {
+        args.insert(args.begin(), "runTests1");
+        _runnerSelfTest = true;
+        try {
+            const int failed = runTests((int)args.size(), (char**)args.data());
+            _runnerSelfTest = false;
+            return failed;
+        }
+        catch (...) {
+            _runnerSelfTest = false;
+            throw;
+        }
+    };
+    auto readJson = [&]() {
+        FILE* const f = fopen(path, "r");
+        assert(f);
+        string json;
+        char buffer[4096];
+        for (size_t n; (n = fread(buffer, 1, sizeof(buffer), f)) > 0;) json.append(buffer, n);
+        fclose(f);
+        remove(path);
+        return json;
+    };
+
+    // filters, in registration order: runnerSample_pass, runnerSample_fail, runnerSample_parallelFail
+    int failed = run({"runnerSample", "-runnerSample_parallel", "--threads=2", "--json=runTests1.json"});
+    assert(failed == 1);
+    string json = readJson();
+    assert(json.find("{\"name\":\"runnerSample_pass\",\"passed\":true,") != string::npos);
+    assert(json.find("{\"name\":\"runnerSample_fail\",\"passed\":false,") != string::npos);
+    assert(json.find("runnerSample_parallelFail") == string::npos);
+    assert(!ASSERT_CHECKED || json.find("fails \\\"on purpose\\\"\\n\\u0009in\\\\runnerSample_fail\\u0001") != string::npos, "%s", json.c_str());
+    assert(json.find("\"failed\":1}") != string::npos);
+
+    // shards
+    failed = run({"runnerSample", "--shard=0/3", "--json=runTests1.json"});
+    json = readJson();
+    assert(failed == 0 && json.find("runnerSample_pass") != string::npos && json.find("runnerSample_fail") == string::npos);
+    failed = run({"runnerSample", "--shard=1/2", "--json=runTests1.json"});
+    json = readJson();
+    assert(json.find("runnerSample_pass") == string::npos && json.find("runnerSample_fail") != string::npos && json.find("runnerSample_parallelFail") == string::npos);
+
+    // an assertion failing in a parallel loop fails its test
+    failed = run({"runnerSample_parallelFail", "--json=runTests1.json"});
+    json = readJson();
+    assert(!ASSERT_CHECKED || (failed == 1 && json.find("fails on purpose in iteration 500") != string::npos), "%s", json.c_str());
+
+    // malformed options are rejected at every assertion level, rather than taken as filters; nothing matches, in case they are not
+    for (const char* const option : {"--shard=3", "--shard=3/3", "--shard=1/0", "--shard=5/2", "--shard=1/2x", "--threads=", "--unknown",
+        "--json=runTests1_missing_directory/runTests1.json"}) {
+        bool rejected = false;
+        try {
+            run({"runnerSample_none", option});
+        }
+        catch (const test_failure&) {
+            rejected = true;
+        }
+        assert(rejected, "%s", option);
+    }
+}
+
+// inputs cycle, so that branch predictors cannot learn a single one
+const char* const _benchmark_decimals[] = {"-1.2345678901234567e-123", "0.5", "3.141592653589793", "123456.789", "6.02214076e23", "-0.000125"};
+const double _benchmark_doubles[] = {-1.2345678901234567e-123, 0.5, M_PI, 123456.789, 6.02214076e23, -0.000125};
+unsigned int _benchmark_input = 0;
+
+BENCHMARK(strtod_fast) {
+    char* e;
+    doNotOptimize(strtod_fast(_benchmark_decimals[_benchmark_input++ % 6], &e));
+}
+
+BENCHMARK(dtostr_fast) {
+    char b[32];
+    char* e;
+    dtostr_fast(_benchmark_doubles[_benchmark_input++ % 6], 17, b, &e);
+    doNotOptimize(b);
+}
+
+BENCHMARK(dtostr_shortest_fast) {
+    char b[32];
+    char* e;
+    dtostr_shortest_fast(_benchmark_doubles[_benchmark_input++ % 6], 17, b, &e);
+    doNotOptimize(b);
+}
+
+BENCHMARK(strtou64_fast) {
+    const char* const s[] = {"0", "42", "123456789", "18446744073709551615"};
+    char* e;
+    doNotOptimize(strtou64_fast(s[_benchmark_input++ % 4], &e));
+}
+
+BENCHMARK(dtohex_fast) {
+    char b[32];
+    char* e;
+    dtohex_fast(_benchmark_doubles[_benchmark_input++ % 6], b, &e);
+    doNotOptimize(b);
+}
+
+BENCHMARK(hextod_fast) {
+    const char* const s[] = {"-0x1.4c6d39d4e7d1ep-409", "+0x1.0000000000000p-0001", "+0x1.921fb54442d18p+0001", "+0x1.e240c9fbe76c9p+0016"};
+    char* e;
+    doNotOptimize(hextod_fast(s[_benchmark_input++ % 4], &e));
+}
+
+// 4096 decimals with 0 to 6 fraction digits, separated by commas and newlines
+const string _benchmark_decimal_text = []() {
+    string text;
+    uint64_t r = 1;
+    char b[32];
+    DO(i, 4096) {
+        _testRandom(r);
+        text.append(b, snprintf(b, sizeof(b), "%.*f%c", (int)(i % 7), (double)(r >> 11) / (1ull << 53) * 2000 - 1000, i % 8 == 7 ? '\n' : ','));
+    }
+    return text;
+}();
+vector<float> _benchmark_parsed_floats(4096);
+
+BENCHMARK_BYTES(strtof_fast_batch_4k, _benchmark_decimal_text.size()) {
+    char* e;
+    const char* const text = _benchmark_decimal_text.data();
+    doNotOptimize(strtof_fast_batch(text, text + _benchmark_decimal_text.size(), ',', _benchmark_parsed_floats.data(), 4096, &e));
+}
+
+// the same with a loop of strtof_fast
+BENCHMARK_BYTES(strtof_fast_loop_4k, _benchmark_decimal_text.size()) {
+    char* e;
+    const char* p = _benchmark_decimal_text.data();
+    DO(i, 4096) {
+        _benchmark_parsed_floats[i] = strtof_fast(p, &e);
+        p = e + 1;
+    }
+    doNotOptimize(_benchmark_parsed_floats.data());
+}
+
+// 1024 finite doubles with random bits, whose shortest representations have all lengths
+const vector<double> _benchmark_random_doubles = []() {
+    vector<double> values;
+    uint64_t r = 1;
+    while (values.size() < 1024) {
+        _testRandom(r);
+        double v;
+        memcpy(&v, &r, 8);
+        if (isfinite(v)) values.push_back(v);
+    }
+    return values;
+}();
+
+BENCHMARK(dtostr_fast_random_1k) {
+    char b[32];
+    char* e;
+    for (const double v : _benchmark_random_doubles) {
+        dtostr_fast(v, 17, b, &e);
+        doNotOptimize(b);
+    }
+}
+
+BENCHMARK(dtostr_shortest_fast_random_1k) {
+    char b[32];
+    char* e;
+    for (const double v : _benchmark_random_doubles) {
+        dtostr_shortest_fast(v, 17, b, &e);
+        doNotOptimize(b);
+    }
+}
+
+// 1024 unsigned integers of all lengths up to 20 digits, one per line
+const string _benchmark_integer_text = []() {
+    string text;
+    uint64_t r = 1;
+    char b[32];
+    REPEAT(1024) {
+        _testRandom(r);
+        text.append(b, snprintf(b, sizeof(b), "%llu\n", (unsigned long long)(r >> (r >> 58))));
+    }
+    return text;
+}();
+
+BENCHMARK(strtou64_fast_1k) {
+    char* e;
+    unsigned long long sum = 0;
+    for (const char* p = _benchmark_integer_text.data(); p < _benchmark_integer_text.data() + _benchmark_integer_text.size(); p = e + 1) sum += strtou64_fast(p, &e);
+    doNotOptimize(sum);
+}
+
+// the same with strtoull
+BENCHMARK(strtoull_1k) {
+    char* e;
+    unsigned long long sum = 0;
+    for (const char* p = _benchmark_integer_text.data(); p < _benchmark_integer_text.data() + _benchmark_integer_text.size(); p = e + 1) sum += strtoull(p, &e, 10);
+    doNotOptimize(sum);
+}
+
+#if PAUL_CPP17
+// the same with std::from_chars
+BENCHMARK(from_chars_u64_1k) {
+    const char* const end = _benchmark_integer_text.data() + _benchmark_integer_text.size();
+    unsigned long long sum = 0;
+    for (const char* p = _benchmark_integer_text.data(); p < end;) {
+        uint64_t x = 0;
+        p = from_chars(p, end, x).ptr + 1;
+        sum += x;
+    }
+    doNotOptimize(sum);
+}
+#endif
+
+TEST(divisible1) {
+    assert(divisible(8u, 8u));
+    assert(divisible(8, 8));
+    assert(!divisible(7, 8));
+    assert(divisible(8000000, 8));
+    assert(!divisible(28, 8));
+}
+
+
+FUNCTION(unsigned int, restrictSize, (const size_t s), "Convert s to unsigned int, undefined (assertion error) if s is too large for this (loss of information would occur)", PURITY_PURE) {
+    assert(s <= 0xffffffffu);
+    return (unsigned int)s;
+}
+
+
+FUNCTION(bool, aligned,(void* p, unsigned int m), "Whether the pointer is aligned by the given size") {
+    return divisible((unsigned long long) p, m);
+}
+
+TEST(aligned1) {
+    assert(aligned((void*)0x4, 4u));
+    assert(!aligned((void*)0x8, 6u));
+    assert(aligned((void*)0x8, 8u));
+}
+
+// Page backed arrays, see GLOBALDYNAMICARRAY_ALIGNED
+
+/*
+back with huge pages (2 MiB), which cuts TLB misses for large arrays:
+on Linux with MAP_HUGETLB if huge pages are reserved, else transparent huge pages (madvise),
+on Windows with large pages if the process has SeLockMemoryPrivilege, else normal pages
+*/
+const unsigned int ARRAY_HUGE_PAGES = 1;
+
+struct ArrayStorage {
+    size_t capacity; // bytes
+    size_t alignment;
+    unsigned int flags;
+};
+
+/*
+grows the pages at data (0 initially) with *capacity bytes to at least bytes, keeping their contents, new bytes are 0.
+grows in place or by remapping if possible (mremap on Linux), else copies.
+alignment is a power of two, at most 64 KiB on Windows.
+returns the new address, or 0 if out of memory (leaving data as it was)
+*/
+void* reserve_pages(void* data, size_t* capacity, size_t bytes, size_t alignment, unsigned int flags);
+void release_pages(void* data, size_t capacity);
+
+// grows geometrically, so that repeatedly growing by one element is amortized constant time
+template<typename T>
+CPU_FUNCTION(void, reserveArray, (T*& a, ArrayStorage& storage, size_t n), "Makes room for n elements in a", PURITY_OUTPUT_POINTERS) {
+    assert(n <= SIZE_MAX / sizeof(T));
+    if (n * sizeof(T) <= storage.capacity) return;
+    void* const p = reserve_pages(a, &storage.capacity, max(n * sizeof(T), storage.capacity + storage.capacity / 2), storage.alignment, storage.flags);
+    assert(p, "out of memory reserving %zu elements", n);
+    a = (T*)p;
+}
+
+template<typename T>
+CPU_FUNCTION(void, resizeArray, (T*& a, size_t& size, ArrayStorage& storage, size_t n), "Sets the size of a to n", PURITY_OUTPUT_POINTERS) {
+    reserveArray(a, storage, n);
+    size = n;
+}
+
+template<typename T>
+CPU_FUNCTION(void, freeArray, (T*& a, size_t& size, ArrayStorage& storage), "Releases the memory of a", PURITY_OUTPUT_POINTERS) {
+    release_pages(a, storage.capacity);
+    a = 0;
+    size = 0;
+    storage.capacity = 0;
+}
+
+GLOBALDYNAMICARRAY64(float, _test_array64, _test_array64_size, "array for globaldynamicarray_aligned1")
+GLOBALDYNAMICARRAY_ALIGNED(double, _test_array_huge, _test_array_huge_size, 4096, ARRAY_HUGE_PAGES, "array for globaldynamicarray_aligned1")
+
+TEST(globaldynamicarray_aligned1) {
+    GLOBALDYNAMICARRAY_RESIZE(_test_array64, _test_array64_size, 1000);
+    assert(aligned(_test_array64, 64) && _test_array64_size == 1000);
+    DO(i, _test_array64_size) _test_array64[i] = (float)i;
+
+    // many reallocations (going past 2^31 elements would take too long for a test)
+    DO1(k, 20) {
+        GLOBALDYNAMICARRAY_RESIZE(_test_array64, _test_array64_size, 1000 + k * 100000);
+        assert(aligned(_test_array64, 64));
+        _test_array64[_test_array64_size - 1] = 1;
+    }
+    DO(i, 1000) assert(_test_array64[i] == (float)i);
+    const size_t capacity = _test_array64_storage.capacity;
+    GLOBALDYNAMICARRAY_RESIZE(_test_array64, _test_array64_size, 10);
+    assert(_test_array64_storage.capacity == capacity && _test_array64[9] == 9.f);
+    GLOBALDYNAMICARRAY_FREE(_test_array64, _test_array64_size);
+    assert(!_test_array64 && !_test_array64_size);
+
+    GLOBALDYNAMICARRAY_RESERVE(_test_array_huge, 1 << 20);
+    assert(aligned(_test_array_huge, 4096) && _test_array_huge_size == 0 && _test_array_huge_storage.capacity >= (1 << 20) * sizeof(double));
+    GLOBALDYNAMICARRAY_RESIZE(_test_array_huge, _test_array_huge_size, 1 << 20);
+    _test_array_huge[(1 << 20) - 1] = 1.;
+    GLOBALDYNAMICARRAY_RESIZE(_test_array_huge, _test_array_huge_size, 3 << 20);
+    assert(_test_array_huge[(1 << 20) - 1] == 1. && _test_array_huge[(3 << 20) - 1] == 0.);
+#ifdef __linux__
+    assert(aligned(_test_array_huge, 2 << 20)); // still covered by huge pages after growing
+#endif
+    GLOBALDYNAMICARRAY_FREE(_test_array_huge, _test_array_huge_size);
+
+    // alignments above the page size survive growing
+    size_t capacity1m = 0;
+    char* p = (char*)reserve_pages(0, &capacity1m, 5000, 1 << 20, 0);
+    assert(p && aligned(p, 1 << 20));
+    p[4999] = 1;
+    DO1(k, 8) {
+        p = (char*)reserve_pages(p, &capacity1m, k << 20, 1 << 20, 0);
+        assert(p && aligned(p, 1 << 20) && capacity1m >= k << 20 && p[4999] == 1);
+        p[(k << 20) - 1] = 1;
+    }
+    release_pages(p, capacity1m);
+}
+
+/*
+Snapshots: named typed arrays in one binary file, to be mapped back into memory without parsing or copying.
+
+Layout, little endian:
+SnapshotHeader
+SnapshotEntry[count], the directory
+the payloads, each at an offset that is a multiple of snapshot_page_size, so each is page aligned once mapped
+
+The version is increased whenever the layout changes, readers reject other versions.
+The header and directory carry a checksum that Snapshot::open always verifies.
+The payload checksums are only verified on request, as that reads all pages.
+*/
+const uint32_t snapshot_version = 1;
+const size_t snapshot_page_size = 4096; // the largest alignment of arrays in a snapshot
+
+enum SnapshotType : uint32_t {
+    SNAPSHOT_BYTES, // any other trivially copyable type, identified by its size only
+    SNAPSHOT_INT8, SNAPSHOT_UINT8, SNAPSHOT_INT16, SNAPSHOT_UINT16, SNAPSHOT_INT32, SNAPSHOT_UINT32, SNAPSHOT_INT64, SNAPSHOT_UINT64,
+    SNAPSHOT_FLOAT32, SNAPSHOT_FLOAT64,
+    SNAPSHOT_FLOAT16, SNAPSHOT_BFLOAT16 // half and bfloat16
+};
+
+template<typename T>
+constexpr SnapshotType snapshotType() {
+    static_assert(is_trivially_copyable<T>::value, "snapshots store the bytes of their arrays");
+    return is_floating_point<T>::value ? (sizeof(T) == 4 ? SNAPSHOT_FLOAT32 : sizeof(T) == 8 ? SNAPSHOT_FLOAT64 : SNAPSHOT_BYTES)
+        : !is_integral<T>::value || sizeof(T) > 8 ? SNAPSHOT_BYTES
+        : (SnapshotType)(SNAPSHOT_INT8 + 2 * (sizeof(T) == 1 ? 0 : sizeof(T) == 2 ? 1 : sizeof(T) == 4 ? 2 : 3) + !is_signed<T>::value);
+}
+
+struct SnapshotHeader {
+    char magic[8]; // "PAULSNAP"
+    uint32_t version;
+    uint32_t count; // of entries
+    uint64_t file_size;
+    uint64_t checksum; // of the directory and this header, with checksum 0
+};
+
+struct SnapshotEntry {
+    char name[96]; // 0 terminated
+    SnapshotType type;
+    uint32_t element_size;
+    uint64_t length; // in elements
+    uint64_t alignment;
+    uint64_t offset; // of the payload from the start of the file
+    uint64_t checksum; // of the payload
+};
+
+static_assert(sizeof(SnapshotHeader) == 32 && sizeof(SnapshotEntry) == 136, "the snapshot layout must not depend on the compiler");
+
+CPU_FUNCTION(uint64_t, snapshotChecksum, (_In_reads_(bytes) const void* data, size_t bytes), "A 64 bit hash of the bytes, to detect corruption (not tampering)", PURITY_PURE) {
+    // 4 independent multiply-xorshift lanes over 32 bytes at a time, so that the multiplications overlap
+    const char* const p = (const char*)data;
+    uint64_t h[4] = {1, 2, 3, 4};
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32) DO(j, 4) {
+        uint64_t w;
+        memcpy(&w, p + i + 8 * j, 8);
+        h[j] = (h[j] ^ w) * 0x9E3779B97F4A7C15ull;
+        h[j] ^= h[j] >> 29;
+    }
+    for (unsigned int j = 0; i < bytes; i += 8, j++) {
+        uint64_t w = 0;
+        memcpy(&w, p + i, min((size_t)8, bytes - i));
+        h[j] = (h[j] ^ w) * 0x9E3779B97F4A7C15ull;
+        h[j] ^= h[j] >> 29;
+    }
+    uint64_t r = bytes;
+    DO(j, 4) r = (r ^ h[j]) * 0xC2B2AE3D27D4EB4Full, r ^= r >> 31;
+    return r;
+}
+
+/*
+Collects arrays and writes them as a snapshot. The arrays are only read by write, so they must stay valid until then.
+e.g.
+SnapshotWriter w;
+w.add("weights", weights, n);
+SNAPSHOT_ADD(w, globalArray, globalArraySize); // named globalArray
+w.write("state.snapshot");
+*/
+class SnapshotWriter {
+    vector<SnapshotEntry> entries;
+    vector<const void*> data;
+
+public:
+    template<typename T>
+    CPU_MEMBERFUNCTION(void, add, (_In_z_ const char* name, _In_reads_(n) const T* a, size_t n, size_t alignment = alignof(T)), "Adds a[0 ... n-1] under name", PURITY_OUTPUT_POINTERS) {
+        SnapshotEntry e = {};
+        assert(strlen(name) < sizeof(e.name), "snapshot array name %s is too long", name);
+        assert(alignment && !(alignment & (alignment - 1)) && alignment <= snapshot_page_size, "alignment %zu", alignment);
+        DO(i, entries.size()) assert(strcmp(entries[i].name, name), "%s is already in the snapshot", name);
+        strcpy(e.name, name);
+        e.type = snapshotType<T>();
+        e.element_size = (uint32_t)sizeof(T);
+        e.length = n;
+        e.alignment = alignment;
+        entries.push_back(e);
+        data.push_back(a);
+    }
+
+    CPU_MEMBERFUNCTION(bool, write, (_In_z_ const char* path), "Writes all arrays to path, replacing it. Returns false if that fails.", PURITY_ENVIRONMENT_DEPENDENT) {
+        SnapshotHeader h = {};
+        memcpy(h.magic, "PAULSNAP", 8);
+        h.version = snapshot_version;
+        h.count = (uint32_t)entries.size();
+        uint64_t offset = sizeof(SnapshotHeader) + entries.size() * sizeof(SnapshotEntry);
+        DO(i, entries.size()) {
+            SnapshotEntry& e = entries[i];
+            offset = (offset + snapshot_page_size - 1) / snapshot_page_size * snapshot_page_size;
+            e.offset = offset;
+            e.checksum = snapshotChecksum(data[i], e.length * e.element_size);
+            offset += e.length * e.element_size;
+        }
+        h.file_size = offset;
+        h.checksum = snapshotChecksum(entries.data(), entries.size() * sizeof(SnapshotEntry)) ^ snapshotChecksum(&h, sizeof(h));
+
+        FILE* const f = fopen(path, "wb");
+        if (!f) return false;
+        bool ok = fwrite(&h, sizeof(h), 1, f) == 1 && fwrite(entries.data(), sizeof(SnapshotEntry), entries.size(), f) == entries.size();
+        uint64_t written = sizeof(SnapshotHeader) + entries.size() * sizeof(SnapshotEntry);
+        const char zeros[snapshot_page_size] = {0};
+        DO(i, entries.size()) {
+            const SnapshotEntry& e = entries[i];
+            const size_t bytes = e.length * e.element_size;
+            ok = ok && fwrite(zeros, 1, e.offset - written, f) == e.offset - written && (!bytes || fwrite(data[i], 1, bytes, f) == bytes); // data[i] may be 0 if empty
+            written = e.offset + bytes;
+        }
+        return fclose(f) == 0 && ok;
+    }
+};
+
+#define SNAPSHOT_ADD(writer, name, sizevar) (writer).add(#name, name, (size_t)(sizevar))
+
+/*
+A snapshot mapped into memory, copy on write: the arrays are used where they are in the mapping,
+their pages read from the file when first touched. They may be changed, which changes neither the file nor other readers.
+Pointers into it are valid until it is closed or destroyed.
+*/
+class Snapshot {
+    const char* data = 0;
+    size_t size = 0;
+    const SnapshotHeader* header = 0;
+    const SnapshotEntry* entries = 0;
+
+public:
+    Snapshot() {}
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+    ~Snapshot() { close(); }
+
+    /*
+    maps the snapshot at path. false if the file cannot be read, is no snapshot of this version,
+    its header or directory are corrupt, or, with verify, the checksum of any array does not match
+    */
+    CPU_MEMBERFUNCTION(bool, open, (_In_z_ const char* path, bool verify = false), "", PURITY_ENVIRONMENT_DEPENDENT) {
+        close();
+        data = map_file(path, &size, MAP_FILE_COPY_ON_WRITE);
+        if (!data) return false;
+        header = (const SnapshotHeader*)data;
+        entries = (const SnapshotEntry*)(header + 1);
+
+        bool ok = size >= sizeof(SnapshotHeader) && !memcmp(header->magic, "PAULSNAP", 8) && header->version == snapshot_version &&
+            header->file_size == size && header->count <= (size - sizeof(SnapshotHeader)) / sizeof(SnapshotEntry);
+        if (ok) {
+            SnapshotHeader h = *header;
+            h.checksum = 0;
+            ok = header->checksum == (snapshotChecksum(entries, header->count * sizeof(SnapshotEntry)) ^ snapshotChecksum(&h, sizeof(h)));
+        }
+        for (uint32_t i = 0; ok && i < header->count; i++) {
+            const SnapshotEntry& e = entries[i];
+            ok = memchr(e.name, 0, sizeof(e.name)) && e.offset % snapshot_page_size == 0 && e.element_size && e.offset <= size &&
+                e.length <= (size - e.offset) / e.element_size && (!verify || snapshotChecksum(data + e.offset, e.length * e.element_size) == e.checksum);
+        }
+        if (!ok) close();
+        return ok;
+    }
+
+    CPU_MEMBERFUNCTION(void, close, (), "Unmaps the snapshot", PURITY_OUTPUT_POINTERS) {
+        if (data) unmap_file(data, size);
+        data = 0, size = 0, header = 0, entries = 0;
+    }
+
+    CPU_MEMBERFUNCTION(size_t, count, () const, "The number of arrays", PURITY_PURE) {
+        return header ? header->count : 0;
+    }
+
+    CPU_MEMBERFUNCTION(const SnapshotEntry&, entry, (size_t i) const, "The description of the ith array", PURITY_PURE) {
+        assert(i < count());
+        return entries[i];
+    }
+
+    CPU_MEMBERFUNCTION(const SnapshotEntry*, find, (_In_z_ const char* name) const, "The array called name, 0 if there is none", PURITY_PURE) {
+        DO(i, count()) if (!strcmp(entries[i].name, name)) return entries + i;
+        return 0;
+    }
+
+    // the array called name, with its length in n, or 0 if there is no such array of type T
+    template<typename T>
+    CPU_MEMBERFUNCTION(T*, get, (_In_z_ const char* name, _Out_ size_t& n) const, "", PURITY_OUTPUT_POINTERS) {
+        n = 0;
+        const SnapshotEntry* const e = find(name);
+        if (!e || e->type != snapshotType<T>() || e->element_size != sizeof(T)) return 0;
+        n = (size_t)e->length;
+        return (T*)(data + e->offset);
+    }
+
+    CPU_MEMBERFUNCTION(bool, verify, (_In_z_ const char* name) const, "Whether the array called name exists and matches its checksum. Reads all of it.", PURITY_PURE) {
+        const SnapshotEntry* const e = find(name);
+        return e && snapshotChecksum(data + e->offset, e->length * e->element_size) == e->checksum;
+    }
+};
+
+/*
+points the array name (e.g. declared with GLOBALDYNAMICARRAY) at the array of the same name in the snapshot, and sets sizevar to its length.
+false, leaving both unchanged, if there is no such array of the right type.
+the array must not be freed or resized, GLOBALDYNAMICARRAY_ALIGNED ones must be copied instead
+*/
+#define SNAPSHOT_MAP(snapshot, name, sizevar) _snapshotMap(snapshot, #name, name, sizevar)
+
+template<typename T, typename Size>
+CPU_FUNCTION(bool, _snapshotMap, (const Snapshot& s, _In_z_ const char* name, T*& a, Size& size), "see SNAPSHOT_MAP", PURITY_OUTPUT_POINTERS) {
+    size_t n;
+    T* const p = s.get<T>(name, n);
+    if (!p || (size_t)(Size)n != n) return false;
+    a = p;
+    size = (Size)n;
+    return true;
+}
+
+GLOBALDYNAMICARRAY(int, _test_snapshot_ints, _test_snapshot_ints_size, "array for snapshot1")
+
+TEST_SERIAL(snapshot1) {
+    GLOBALDYNAMICARRAY_RESIZE(_test_array64, _test_array64_size, 100000);
+    DO(i, _test_array64_size) _test_array64[i] = (float)i / 3;
+    vector<double> d(12345);
+    DO(i, d.size()) d[i] = sin((double)i);
+    vector<int> ints = {1, -2, 3};
+    struct Pair { int a; short b; };
+    const Pair pairs[2] = {{1, 2}, {3, 4}};
+
+    const char* const path = "snapshot1.snapshot";
+    SnapshotWriter w;
+    SNAPSHOT_ADD(w, _test_array64, _test_array64_size);
+    w.add("doubles", d.data(), d.size());
+    w.add("_test_snapshot_ints", ints.data(), ints.size());
+    w.add("pairs", pairs, 2);
+    w.add("empty", (const char*)0, 0);
+    const bool written = w.write(path);
+    assert(written);
+    GLOBALDYNAMICARRAY_FREE(_test_array64, _test_array64_size);
+
+    {
+        Snapshot s;
+        const bool opened = s.open(path, true);
+        assert(opened && s.count() == 5);
+        size_t n;
+        float* const f = s.get<float>("_test_array64", n);
+        assert(f && n == 100000 && aligned(f, snapshot_page_size));
+        DO(i, n) assert(f[i] == (float)i / 3);
+        const double* const dd = s.get<double>("doubles", n);
+        assert(dd && n == d.size() && !memcmp(dd, d.data(), n * sizeof(double)));
+        assert(!s.get<float>("doubles", n) && n == 0 && !s.get<double>("missing", n) && !s.get<unsigned int>("_test_snapshot_ints", n));
+        const Pair* const p = s.get<Pair>("pairs", n);
+        assert(p && n == 2 && p[1].a == 3 && p[1].b == 4 && s.entry(3).type == SNAPSHOT_BYTES);
+        assert(s.get<char>("empty", n) && n == 0 && s.entry(0).type == SNAPSHOT_FLOAT32 && s.entry(2).type == SNAPSHOT_INT32);
+
+        // zero copy, and copy on write
+        const bool mapped = SNAPSHOT_MAP(s, _test_snapshot_ints, _test_snapshot_ints_size);
+        assert(mapped && _test_snapshot_ints_size == 3 && _test_snapshot_ints[1] == -2);
+        _test_snapshot_ints[1] = 5;
+        assert(s.verify("doubles") && !s.verify("_test_snapshot_ints") && !s.verify("missing"));
+        _test_snapshot_ints = 0, _test_snapshot_ints_size = 0;
+    }
+    {
+        Snapshot s;
+        const bool opened = s.open(path, true);
+        assert(opened); // unchanged by the write above
+    }
+
+    // names must be 0 terminated, even with matching checksums
+    {
+        size_t size;
+        const char* const mapped = map_file(path, &size);
+        assert(mapped);
+        vector<char> bytes(mapped, mapped + size);
+        unmap_file(mapped, size);
+        SnapshotHeader* const h = (SnapshotHeader*)bytes.data();
+        SnapshotEntry* const e = (SnapshotEntry*)(h + 1);
+        memset(e[1].name, 'x', sizeof(e[1].name));
+        h->checksum = 0;
+        h->checksum = snapshotChecksum(e, h->count * sizeof(SnapshotEntry)) ^ snapshotChecksum(h, sizeof(*h));
+        const char* const unterminated = "snapshot1_unterminated.snapshot";
+        FILE* const f = fopen(unterminated, "wb");
+        assert(f);
+        fwrite(bytes.data(), 1, bytes.size(), f);
+        fclose(f);
+        Snapshot s;
+        const bool opened = s.open(unterminated);
+        assert(!opened && !s.count());
+        remove(unterminated);
+    }
+
+    // corrupt payloads are found with verify, corrupt headers always
+    FILE* f = fopen(path, "r+b");
+    assert(f);
+    fseek(f, 3 * (long)snapshot_page_size + 17, SEEK_SET);
+    fputc(0x55, f);
+    fclose(f);
+    {
+        Snapshot s;
+        const bool verified = s.open(path, true);
+        const bool opened = s.open(path);
+        assert(!verified && opened && !s.verify("_test_array64") && s.verify("doubles"));
+    }
+    f = fopen(path, "r+b");
+    assert(f);
+    fseek(f, sizeof(SnapshotHeader) + 1, SEEK_SET);
+    fputc('x', f);
+    fclose(f);
+    {
+        Snapshot s;
+        assert(!s.open(path) && !s.count() && !s.open("missing.snapshot"));
+    }
+    remove(path);
+}
+
+// Arena allocation, instead of malloc/new
+// An Arena hands out memory by bumping a pointer and frees it all at once, or everything allocated after a marker.
+// Its blocks come from reserve_pages and double in size, so addresses stay valid until the memory is rewound over.
+
+struct ArenaMarker {
+    unsigned int block;
+    size_t used;
+};
+
+class Arena {
+    static const unsigned int max_blocks = 48;
+    struct Block {
+        char* data;
+        size_t capacity;
+    };
+    Block blocks[max_blocks];
+    unsigned int nblocks = 0, current = 0;
+    size_t used = 0; // bytes of blocks[current]
+    const size_t first_block;
+
+    CPU_MEMBERFUNCTION(void, addBlock, (size_t bytes), "Appends a block of at least bytes", PURITY_OUTPUT_POINTERS) {
+        assert(nblocks < max_blocks);
+        Block& b = blocks[nblocks];
+        b.capacity = 0;
+        b.data = (char*)reserve_pages(0, &b.capacity, max(first_block << min(nblocks, 32u), bytes), 4096, 0);
+        assert(b.data, "out of memory allocating %zu bytes", bytes);
+        nblocks++;
+    }
+
+public:
+    Arena(size_t first_block = 1 << 16) : first_block(first_block) {}
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    ~Arena() {
+        DO(i, nblocks) release_pages(blocks[i].data, blocks[i].capacity);
+    }
+
+    CPU_MEMBERFUNCTION(void*, allocate, (size_t bytes, size_t alignment = 16), "bytes aligned to alignment (a power of two, at most 4096), valid until rewound over", PURITY_OUTPUT_POINTERS) {
+        assert(alignment && !(alignment & (alignment - 1)) && alignment <= 4096, "bad alignment %zu", alignment);
+        for (;; current++, used = 0) { // blocks are reused after a rewind, skipping those too small
+            if (current == nblocks) addBlock(bytes);
+            const size_t start = (used + alignment - 1) & ~(alignment - 1); // blocks are page aligned
+            if (start + bytes <= blocks[current].capacity) {
+                used = start + bytes;
+                return blocks[current].data + start;
+            }
+        }
+    }
+
+    template<typename T>
+    CPU_MEMBERFUNCTION(T*, allocateArray, (size_t n), "n uninitialized Ts", PURITY_OUTPUT_POINTERS) {
+        return (T*)allocate(n * sizeof(T), max(alignof(T), (size_t)16));
+    }
+
+    CPU_MEMBERFUNCTION(ArenaMarker, mark, (), "The current position, for rewind", PURITY_PURE) {
+        return {current, used};
+    }
+
+    CPU_MEMBERFUNCTION(void, rewind, (ArenaMarker m), "Frees everything allocated after m was taken. The memory is kept for reuse.", PURITY_OUTPUT_POINTERS) {
+        current = m.block;
+        used = m.used;
+    }
+
+    CPU_MEMBERFUNCTION(void, reset, (), "Frees everything. The memory is kept for reuse.", PURITY_OUTPUT_POINTERS) {
+        rewind({0, 0});
+    }
+};
+
+// Rewinds arena to where it was at construction when going out of scope
+struct ArenaScope {
+    Arena& arena;
+    const ArenaMarker marker;
+    ArenaScope(Arena& arena) : arena(arena), marker(arena.mark()) {}
+    ~ArenaScope() { arena.rewind(marker); }
+};
+
+// An STL allocator taking memory from an Arena, e.g. vector<int, ArenaAllocator<int>> v(ArenaAllocator<int>(arena)).
+// deallocate does nothing, the memory is freed with the arena.
+template<typename T>
+struct ArenaAllocator {
+    typedef T value_type;
+    Arena* arena;
+
+    ArenaAllocator(Arena& arena) : arena(&arena) {}
+    template<typename U> ArenaAllocator(const ArenaAllocator<U>& a) : arena(a.arena) {}
+
+    T* allocate(size_t n) { return arena->allocateArray<T>(n); }
+    void deallocate(T*, size_t) {}
+};
+
+template<typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena == b.arena; }
+template<typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena != b.arena; }
+
+/*
+A thread-safe allocator of blocks of one fixed size, aligned to alignment (a power of two, at most 4096).
+Freed blocks go to a free list of the freeing thread, which it allocates from without contention.
+A thread whose list is empty takes over another's list, or carves new blocks from slabs that come from reserve_pages.
+All memory is released with the pool.
+*/
+class Pool {
+    static const unsigned int max_slabs = 48, thread_lists = 64;
+    struct alignas(64) FreeList { // own cache line each
+        mutex m; // only contended when more than thread_lists threads use the pool
+        atomic<void*> head{0}; // changed under m, atomic for the peek of other threads
+    };
+    FreeList lists[thread_lists];
+    const size_t block_size;
+    mutex slabs_mutex;
+    char* slabs[max_slabs];
+    size_t slab_capacity[max_slabs];
+    unsigned int nslabs = 0;
+    size_t carved = 0; // bytes of the last slab
+
+    static unsigned int threadList() {
+        static atomic<unsigned int> threads(0);
+        thread_local const unsigned int list = threads++ % thread_lists;
+        return list;
+    }
+
+    static void* pop(FreeList& l) {
+        void* const p = l.head.load(memory_order_relaxed);
+        if (p) l.head.store(*(void**)p, memory_order_relaxed);
+        return p;
+    }
+
+public:
+    Pool(size_t block_size, size_t alignment = 16) : block_size((max(block_size, sizeof(void*)) + alignment - 1) & ~(alignment - 1)) {
+        assert(alignment && !(alignment & (alignment - 1)) && alignment <= 4096, "bad alignment %zu", alignment);
+    }
+    Pool(const Pool&) = delete;
+    Pool& operator=(const Pool&) = delete;
+    ~Pool() {
+        DO(i, nslabs) release_pages(slabs[i], slab_capacity[i]);
+    }
+
+    CPU_MEMBERFUNCTION(void*, allocate, (), "One block", PURITY_OUTPUT_POINTERS) {
+        const unsigned int t = threadList();
+        FreeList& own = lists[t];
+        {
+            lock_guard<mutex> lock(own.m);
+            if (void* const p = pop(own)) return p;
+        }
+        FOR1(unsigned int, j, 1, thread_lists) {
+            FreeList& other = lists[(t + j) % thread_lists];
+            if (!other.head.load(memory_order_relaxed)) continue; // a peek without the lock, just a hint
+            void* p;
+            { // take the whole list, holding one lock at a time
+                lock_guard<mutex> lock(other.m);
+                p = other.head.exchange(0, memory_order_relaxed);
+            }
+            if (!p) continue;
+            void* const rest = *(void**)p;
+            if (rest) {
+                lock_guard<mutex> lock(own.m);
+                if (void* const head = own.head.load(memory_order_relaxed)) { // another thread sharing the list freed meanwhile
+                    void** tail = (void**)rest;
+                    while (*tail) tail = (void**)*tail;
+                    *tail = head;
+                }
+                own.head.store(rest, memory_order_relaxed);
+            }
+            return p;
+        }
+
+        lock_guard<mutex> lock(slabs_mutex);
+        if (!nslabs || carved + block_size > slab_capacity[nslabs - 1]) {
+            assert(nslabs < max_slabs);
+            slab_capacity[nslabs] = 0;
+            slabs[nslabs] = (char*)reserve_pages(0, &slab_capacity[nslabs], max((size_t)1 << 16, 64 * block_size) << min(nslabs, 32u), 4096, 0);
+            assert(slabs[nslabs], "out of memory");
+            nslabs++;
+            carved = 0;
+        }
+        void* const p = slabs[nslabs - 1] + carved;
+        carved += block_size;
+        return p;
+    }
+
+    CPU_MEMBERFUNCTION(void, deallocate, (void* p), "Returns a block from allocate", PURITY_OUTPUT_POINTERS) {
+        FreeList& own = lists[threadList()];
+        lock_guard<mutex> lock(own.m);
+        *(void**)p = own.head.load(memory_order_relaxed);
+        own.head.store(p, memory_order_relaxed);
+    }
+
+    CPU_MEMBERFUNCTION(size_t, blockSize, (), "Bytes per block, a multiple of the alignment", PURITY_PURE) {
+        return block_size;
+    }
+};
+
+TEST(arena1) {
+    Arena arena(4096);
+    char* const a = (char*)arena.allocate(1, 1);
+    const ArenaMarker m = arena.mark();
+    {
+        ArenaScope scope(arena);
+        void* const b = arena.allocate(3, 64);
+        void* const c = arena.allocate(100000, 4096); // a new block
+        double* const d = arena.allocateArray<double>(7);
+        assert(aligned(b, 64) && aligned(c, 4096) && aligned(d, 16));
+    }
+    assert(arena.mark().block == m.block && arena.mark().used == m.used);
+    arena.rewind(m);
+    char* const b = (char*)arena.allocate(1, 1);
+    assert(b == a + 1);
+    arena.reset();
+    char* const c = (char*)arena.allocate(1, 1);
+    assert(c == a);
+
+    vector<int, ArenaAllocator<int>> v{ArenaAllocator<int>(arena)};
+    DO(i, 10000) v.push_back(i);
+    DO(i, 10000) assert(v[i] == (int)i);
+}
+
+TEST(pool1) {
+    Pool pool(24, 32);
+    assert(pool.blockSize() == 32);
+    void* const a = pool.allocate();
+    assert(aligned(a, 32));
+    pool.deallocate(a);
+    void* const b = pool.allocate();
+    assert(b == a);
+
+    // concurrent users get distinct blocks; counted, as assertions on these threads would not fail the test
+    vector<thread> threads;
+    atomic<int> wrong(0);
+    REPEAT(4) threads.emplace_back([&pool, &wrong]() {
+        vector<void*> blocks;
+        REPEAT(10) {
+            DO(i, 1000) {
+                int* const p = (int*)pool.allocate();
+                wrong += !aligned(p, 32);
+                *p = (int)i;
+                blocks.push_back(p);
+            }
+            DO(i, blocks.size()) wrong += *(int*)blocks[i] != (int)i;
+            for (void* p : blocks) pool.deallocate(p);
+            blocks.clear();
+        }
+    });
+    for (auto& t : threads) t.join();
+    assert(wrong == 0);
+}
+
+FUNCTION(bool, after, (void* a, void* b), "C57") {
+    return (unsigned long long)a >= (unsigned long long)b;
+}
+
+FUNCTION(bool, strictly_after, (void* a, void* b), "C58", PURITY_PURE) {
+    return (unsigned long long)a > (unsigned long long)b;
+}
+
+FUNCTION(unsigned int, mod, (int n, unsigned int m), "mod(n, m) Mathematical mod function, returning positive values such that n = x*m + mod(n, m) for some x"
+    "TODO extend, along with floor and ceil and mod to be more general (floor and ceil require < too...)", PURITY_PURE) {
+    // n % m would convert n to unsigned, which is wrong for negative n unless m divides 2^32. -(n + 1) cannot overflow.
+    return n >= 0 ? (unsigned int)n % m : m - 1 - (unsigned int)-(n + 1) % m;
+}
+DECLARE_PURE((unsigned int(*)(int, unsigned int))mod);
+
+TEST(mod1) {
+    assert(mod(-2, 4) == 2);
+    assert(mod(2, 4) == 2);
+    assert(mod(2, 2) == 0);
+    assert(mod(-1, 3) == 2);
+    assert(mod(-3, 3) == 0);
+    assert(mod(INT_MIN, 7) == 5); // -2^31 = -306783379 * 7 + 5
+    assert(mod(-5, 0xffffffffu) == 0xfffffffau);
+}
+
+FUNCTION(int, nextEven, (int i), "C101 Gives the next even signed (two's complement) leint32, i.e. i if this is even, i+1 otherwise. Undefined for 2^31-1. TODO generalize this in a generalized ceil, c.f. Mathematica.", PURITY_PURE) {
+    assert(i != INT_MAX);
+    if (i % 2 == 0) return i;
+    return i + 1;
+}
+DECLARE_PURE(nextEven);
+
+
+// TODO better device implementation
+FUNCTION(float, assertFinite, (float value)
+    , "C56: The function that is the identity for finite single-precision (32 bit little endian) floating point values and undefined otherwise", PURITY_PURE) {
+#ifdef _DEBUG
+#if GPU_CODE
+    assert(1.f * value == value);
+#else
+    assert(isfinite(value), "value = %f is not finite", value);
+#endif
+#endif
+    return value;
+}
+DECLARE_PURE(assertFinite);
+
+/*
+The same for arrays of float or double, checking the exponent bits of 16 floats or 8 doubles per instruction
+with AVX-512, 8 or 4 with AVX2 and 4 or 2 with SSE2, cheap enough to validate whole buffers in release builds.
+*/
+// the index of the first infinite or NaN value among a[0 ... n-1], SIZE_MAX if all are finite
+size_t findFirstNonFinite(const float* a, size_t n);
+size_t findFirstNonFinite(const double* a, size_t n);
+// the amount of infinite or NaN values among a[0 ... n-1]
+size_t countNonFinite(const float* a, size_t n);
+size_t countNonFinite(const double* a, size_t n);
+
+template<typename T>
+FUNCTION(void, assertFiniteArray, (_In_reads_(n) const T* a, size_t n), "Asserts that a[0 ... n-1] are all finite, reporting the index of the first that is not", PURITY_PURE) {
+    const size_t i = findFirstNonFinite(a, n);
+    assert(i == SIZE_MAX, "a[%zu] = %f is not finite, as are %zu of the %zu values", i, (double)a[i], countNonFinite(a, n), n);
+}
+
+TEST(nonFinite1) {
+    const float specials[] = {INFINITY, -INFINITY, NAN, -NAN};
+    for (const size_t n : {0, 1, 63, 64, 65, 200, 1000}) {
+        vector<float> f(n);
+        vector<double> d(n);
+        DO(i, n) f[i] = (i % 2 ? -1.f : 1.f) * (i % 3 ? FLT_MAX : FLT_MIN / 3), d[i] = (i % 2 ? -1. : 1.) * (i % 3 ? DBL_MAX : DBL_MIN / 3);
+        assert(findFirstNonFinite(f.data(), n) == SIZE_MAX && countNonFinite(f.data(), n) == 0);
+        assert(findFirstNonFinite(d.data(), n) == SIZE_MAX && countNonFinite(d.data(), n) == 0);
+        assertFiniteArray(f.data(), n);
+        assertFiniteArray(d.data(), n);
+
+        size_t first = SIZE_MAX, count = 0;
+        for (size_t i = n; i-- > 0;) if (i % 37 == 5 || i == n - 1) {
+            f[i] = specials[i % 4], d[i] = specials[i % 4];
+            first = i, count++;
+        }
+        assert(findFirstNonFinite(f.data(), n) == first && countNonFinite(f.data(), n) == count, "n = %zu", n);
+        assert(findFirstNonFinite(d.data(), n) == first && countNonFinite(d.data(), n) == count, "n = %zu", n);
+        if (!n) continue;
+        bool failed = false;
+        try {
+            assertFiniteArray(d.data(), n);
+        } catch (const test_failure&) {
+            failed = true;
+        }
+        assert(failed || !ASSERT_CHECKED);
+    }
+}
+
+vector<float> _benchmark_finite_floats(1 << 16, 1.f);
+
+BENCHMARK(findFirstNonFinite_64k) {
+    doNotOptimize(findFirstNonFinite(_benchmark_finite_floats.data(), _benchmark_finite_floats.size()));
+}
+
+// one value at a time, like assertFinite
+BENCHMARK(isfinite_64k) {
+    for (const float x : _benchmark_finite_floats) doNotOptimize(isfinite(x));
+}
+
+// Half precision and bfloat16
+// 16 bit storage types for arrays that do not need the precision of float, at half the memory and bandwidth.
+// Compute with float: convert whole arrays with the *_array functions, which use vcvtps2ph/vcvtph2ps (F16C, AVX-512) and shifts.
+// half is IEEE binary16: 11 significant bits, range 6e-8 to 65504. bfloat16 has the range of float with 8 significant bits.
+struct half { uint16_t bits; };
+struct bfloat16 { uint16_t bits; };
+
+// round to nearest even, keeping subnormals; overflow gives inf, NaN stays NaN
+half float_to_half(float value);
+float half_to_float(half value);
+bfloat16 float_to_bfloat16(float value);
+float bfloat16_to_float(bfloat16 value);
+
+void float_to_half_array(_In_reads_(n) const float* in, _Out_writes_(n) half* out, size_t n);
+void half_to_float_array(_In_reads_(n) const half* in, _Out_writes_(n) float* out, size_t n);
+void float_to_bfloat16_array(_In_reads_(n) const float* in, _Out_writes_(n) bfloat16* out, size_t n);
+void bfloat16_to_float_array(_In_reads_(n) const bfloat16* in, _Out_writes_(n) float* out, size_t n);
+
+// digits needed for writing any value such that it reads back exactly
+const int half_digits = 5, bfloat16_digits = 4;
+
+/*
+like ftostr_shortest_fast: digits + dtostr_fast_extra_chars characters, including inf and nan
+*/
+void htostr_fast(half value, int digits, char* str, char** endptr);
+void bf16tostr_fast(bfloat16 value, int digits, char* str, char** endptr);
+
+/*
+like strtof_fast, rounded to nearest even half or bfloat16.
+Rounds the text to double first, which is exact except for decimals within 2^-53 of the midpoint of two values.
+*/
+half strtoh_fast(const char* str, char** endptr);
+bfloat16 strtobf16_fast(const char* str, char** endptr);
+
+template<> constexpr SnapshotType snapshotType<half>() { return SNAPSHOT_FLOAT16; }
+template<> constexpr SnapshotType snapshotType<bfloat16>() { return SNAPSHOT_BFLOAT16; }
+
+TEST(half1) {
+    // every 16 bit pattern converts to float and back unchanged (NaNs only stay NaN), and reads back from its text (-0 is written as +0)
+    char b[32];
+    char* e;
+    for (uint32_t i = 0; i < 65536; i++) {
+        const half h = {(uint16_t)i};
+        const float f = half_to_float(h);
+        const bool nan = (i & 0x7fff) > 0x7c00;
+        assert(nan ? f != f : float_to_half(f).bits == i, "%04x", i);
+        htostr_fast(h, half_digits, b, &e);
+        assert(e == b + half_digits + dtostr_fast_extra_chars);
+        *e = 0;
+        if (!nan && (i & 0x7fff) != 0x7c00) assert((strtoh_fast(b, &e).bits == i || i == 0x8000) && !*e, "%04x %s", i, b);
+
+        const bfloat16 g = {(uint16_t)i};
+        const float x = bfloat16_to_float(g);
+        const bool gnan = (i & 0x7fff) > 0x7f80;
+        assert(gnan ? x != x : float_to_bfloat16(x).bits == i, "%04x", i);
+        bf16tostr_fast(g, bfloat16_digits, b, &e);
+        *e = 0;
+        if (!gnan && (i & 0x7fff) != 0x7f80) assert((strtobf16_fast(b, &e).bits == i || i == 0x8000) && !*e, "%04x %s", i, b);
+    }
+
+    // rounding: ties to even, overflow, subnormals
+    assert(float_to_half(1.f + 1.f / 2048).bits == 0x3c00 && float_to_half(1.f + 3.f / 2048).bits == 0x3c02);
+    assert(float_to_half(65519.f).bits == 0x7bff && float_to_half(65520.f).bits == 0x7c00 && float_to_half(-1e10f).bits == 0xfc00);
+    assert(float_to_half(5.9604645e-8f).bits == 1 && float_to_half(2.9802322e-8f).bits == 0 && float_to_half(2.99e-8f).bits == 1);
+    assert(float_to_bfloat16(1.f + 1.f / 256).bits == 0x3f80 && float_to_bfloat16(1.f + 3.f / 256).bits == 0x3f82);
+    assert(float_to_bfloat16(FLT_MAX).bits == 0x7f80 && float_to_bfloat16(NAN).bits != 0x7f80);
+    assert(strtoh_fast("0.1", &e).bits == 0x2e66 && strtoh_fast("1.00048828125", &e).bits == 0x3c00 && strtoh_fast("1.000488281250001", &e).bits == 0x3c01);
+
+    // the arrays agree with the scalar conversion, whatever the vector width
+    vector<float> f(1000);
+    DO(i, f.size()) f[i] = (i % 2 ? -1.f : 1.f) * ldexpf(1.f + (float)(i * 7919 % 1000) / 999, (int)(i % 60) - 40);
+    f[3] = INFINITY, f[500] = NAN, f[999] = 1e30f;
+    for (const size_t n : {0, 7, 8, 17, 1000}) {
+        vector<half> h(n);
+        vector<bfloat16> g(n);
+        vector<float> back(n), bback(n);
+        float_to_half_array(f.data(), h.data(), n);
+        half_to_float_array(h.data(), back.data(), n);
+        float_to_bfloat16_array(f.data(), g.data(), n);
+        bfloat16_to_float_array(g.data(), bback.data(), n);
+        DO(i, n) {
+            assert(h[i].bits == float_to_half(f[i]).bits || (f[i] != f[i] && back[i] != back[i]), "%u %g", i, f[i]);
+            assert(memcmp(&back[i], &f[i], 4) == 0 ? true : back[i] == half_to_float(h[i]) || back[i] != back[i]);
+            assert(g[i].bits == float_to_bfloat16(f[i]).bits, "%u %g", i, f[i]);
+            assert(bback[i] == bfloat16_to_float(g[i]) || bback[i] != bback[i]);
+        }
+    }
+}
+
+vector<float> _benchmark_half_floats(1 << 16, 1.5f);
+vector<half> _benchmark_halfs(1 << 16);
+vector<bfloat16> _benchmark_bfloat16s(1 << 16);
+
+BENCHMARK(float_to_half_array_64k) {
+    float_to_half_array(_benchmark_half_floats.data(), _benchmark_halfs.data(), _benchmark_halfs.size());
+}
+
+BENCHMARK(half_to_float_array_64k) {
+    half_to_float_array(_benchmark_halfs.data(), _benchmark_half_floats.data(), _benchmark_halfs.size());
+}
+
+BENCHMARK(float_to_bfloat16_array_64k) {
+    float_to_bfloat16_array(_benchmark_half_floats.data(), _benchmark_bfloat16s.data(), _benchmark_bfloat16s.size());
+}
+
+// one value at a time
+BENCHMARK(float_to_half_loop_64k) {
+    DO(i, _benchmark_halfs.size()) _benchmark_halfs[i] = float_to_half(_benchmark_half_floats[i]);
+}
+
+
+// Bit manipulation
+// Compiled to single instructions (lzcnt/bsr, tzcnt/bsf, popcnt, bswap) where the target has them, and usable in constant expressions.
+// MSVC's intrinsics are not constexpr, so there these use portable code when evaluated at compile time (needs C++20's is_constant_evaluated).
+#if defined(__GNUC__) || defined(__clang__)
+#define BIT_CONSTEXPR constexpr
+#define BIT_BUILTINS 1 // constexpr themselves
+#elif defined(__cpp_lib_is_constant_evaluated)
+#define BIT_CONSTEXPR constexpr
+#define BIT_BUILTINS 0
+#define BIT_RUNTIME() (!std::is_constant_evaluated())
+#else
+#define BIT_CONSTEXPR inline
+#define BIT_BUILTINS 0
+#define BIT_RUNTIME() true
+#endif
+
+FUNCTION(BIT_CONSTEXPR unsigned int, _highest_bit_position32, (uint32_t x), "see highest_bit_position", PURITY_PURE) {
+#if BIT_BUILTINS
+    return 31 - __builtin_clz(x | 1);
+#else
+    if (BIT_RUNTIME()) {
+#ifdef __AVX2__ // implies lzcnt
+        return 31 - _lzcnt_u32(x | 1);
+#else
+        unsigned long i = 0;
+        _BitScanReverse(&i, x | 1);
+        return i;
+#endif
+    }
+    unsigned int p = 0;
+    while (x >>= 1) p++;
+    return p;
+#endif
+}
+FUNCTION(BIT_CONSTEXPR unsigned int, _highest_bit_position64, (uint64_t x), "see highest_bit_position", PURITY_PURE) {
+#if BIT_BUILTINS
+    return 63 - __builtin_clzll(x | 1);
+#else
+    if (BIT_RUNTIME()) {
+#ifdef __AVX2__
+        return 63 - (unsigned int)_lzcnt_u64(x | 1);
+#else
+        unsigned long i = 0;
+        _BitScanReverse64(&i, x | 1);
+        return i;
+#endif
+    }
+    unsigned int p = 0;
+    while (x >>= 1) p++;
+    return p;
+#endif
+}
+FUNCTION(BIT_CONSTEXPR unsigned int, _lowest_bit_position32, (uint32_t x), "see lowest_bit_position", PURITY_PURE) {
+#if BIT_BUILTINS
+    return x ? __builtin_ctz(x) : 32;
+#else
+    if (BIT_RUNTIME()) {
+#ifdef __AVX2__ // implies tzcnt
+        return _tzcnt_u32(x);
+#else
+        unsigned long i = 32;
+        return _BitScanForward(&i, x) ? i : 32;
+#endif
+    }
+    if (!x) return 32;
+    unsigned int p = 0;
+    for (; !(x & 1); x >>= 1) p++;
+    return p;
+#endif
+}
+
+FUNCTION(BIT_CONSTEXPR unsigned int, _lowest_bit_position64, (uint64_t x), "see lowest_bit_position", PURITY_PURE) {
+#if BIT_BUILTINS
+    return x ? __builtin_ctzll(x) : 64;
+#else
+    if (BIT_RUNTIME()) {
+#ifdef __AVX2__
+        return (unsigned int)_tzcnt_u64(x);
+#else
+        unsigned long i = 64;
+        return _BitScanForward64(&i, x) ? i : 64;
+#endif
+    }
+    if (!x) return 64;
+    unsigned int p = 0;
+    for (; !(x & 1); x >>= 1) p++;
     return p;
-}
\ No newline at end of file
+#endif
+}
+
+FUNCTION(BIT_CONSTEXPR unsigned int, _bit_count64, (uint64_t x), "see bit_count", PURITY_PURE) {
+#if BIT_BUILTINS
+    return __builtin_popcountll(x);
+#else
+#ifdef __AVX__ // implies popcnt
+    if (BIT_RUNTIME()) return (unsigned int)__popcnt64(x);
+#endif
+    x -= (x >> 1) & 0x5555555555555555ull;
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0full;
+    return (unsigned int)((x * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+FUNCTION(BIT_CONSTEXPR uint64_t, _bit_reverse64, (uint64_t x), "see bit_reverse", PURITY_PURE) {
+    // swap neighbouring bits, pairs, nibbles, then reverse the bytes
+    x = ((x >> 1) & 0x5555555555555555ull) | ((x & 0x5555555555555555ull) << 1);
+    x = ((x >> 2) & 0x3333333333333333ull) | ((x & 0x3333333333333333ull) << 2);
+    x = ((x >> 4) & 0x0f0f0f0f0f0f0f0full) | ((x & 0x0f0f0f0f0f0f0f0full) << 4);
+#if BIT_BUILTINS
+    return __builtin_bswap64(x);
+#else
+    if (BIT_RUNTIME()) return _byteswap_uint64(x);
+    x = ((x >> 8) & 0x00ff00ff00ff00ffull) | ((x & 0x00ff00ff00ff00ffull) << 8);
+    x = ((x >> 16) & 0x0000ffff0000ffffull) | ((x & 0x0000ffff0000ffffull) << 16);
+    return (x >> 32) | (x << 32);
+#endif
+}
+
+FUNCTION(BIT_CONSTEXPR uint64_t, _next_power_of_two64, (uint64_t x), "see next_power_of_two", PURITY_PURE) {
+    return x <= 1 ? 1 : _highest_bit_position64(x - 1) == 63 ? 0 : (uint64_t)2 << _highest_bit_position64(x - 1);
+}
+
+/*
+The functions for any integer x of up to 64 bits, e.g. highest_bit_position(5), highest_bit_position(size).
+Types of up to 32 bits are taken as 32 bit unsigned integers, others as 64 bit ones (signed ones as if converted to these).
+*/
+template<typename T>
+using _BitWord = typename conditional<sizeof(T) <= 4, uint32_t, uint64_t>::type;
+
+template<typename T>
+FUNCTION(BIT_CONSTEXPR unsigned int, highest_bit_position, (T x), "C199 The position of the most significant 1 bit of x, 0 for 0", PURITY_PURE) {
+    static_assert(is_integral<T>::value && sizeof(T) <= 8, "an integer of at most 64 bits");
+    return sizeof(T) <= 4 ? _highest_bit_position32((uint32_t)x) : _highest_bit_position64((uint64_t)x);
+}
+DECLARE_PURE(highest_bit_position<uint32_t>);
+DECLARE_PURE(highest_bit_position<uint64_t>);
+
+template<typename T>
+FUNCTION(BIT_CONSTEXPR unsigned int, lowest_bit_position, (T x), "The position of the least significant 1 bit of x, 32 or 64 (the bits of _BitWord<T>) for 0", PURITY_PURE) {
+    static_assert(is_integral<T>::value && sizeof(T) <= 8, "an integer of at most 64 bits");
+    return sizeof(T) <= 4 ? _lowest_bit_position32((uint32_t)x) : _lowest_bit_position64((uint64_t)x);
+}
+
+template<typename T>
+FUNCTION(BIT_CONSTEXPR unsigned int, bit_count, (T x), "The amount of 1 bits in x (population count)", PURITY_PURE) {
+    static_assert(is_integral<T>::value && sizeof(T) <= 8, "an integer of at most 64 bits");
+    return _bit_count64((_BitWord<T>)x);
+}
+
+template<typename T>
+FUNCTION(BIT_CONSTEXPR _BitWord<T>, bit_reverse, (T x), "x with bit i moved to bit 31 - i or 63 - i", PURITY_PURE) {
+    static_assert(is_integral<T>::value && sizeof(T) <= 8, "an integer of at most 64 bits");
+    return (_BitWord<T>)(_bit_reverse64((uint64_t)(_BitWord<T>)x) >> (64 - 8 * sizeof(_BitWord<T>)));
+}
+
+template<typename T>
+FUNCTION(BIT_CONSTEXPR _BitWord<T>, next_power_of_two, (T x), "The smallest power of two >= x, 1 for 0, 0 if it exceeds 2^31 or 2^63", PURITY_PURE) {
+    static_assert(is_integral<T>::value && sizeof(T) <= 8, "an integer of at most 64 bits");
+    return (_BitWord<T>)_next_power_of_two64((uint64_t)(_BitWord<T>)x); // 2^32 becomes 0 for 32 bits
+}
+
+/*
+the same over arrays of n 64 bit words (bitsets, bit i of the array being bit i % 64 of word i / 64),
+with AVX-512 (VPOPCNTDQ) or AVX2 when compiled for them
+*/
+// the amount of 1 bits
+size_t bit_count_array(const uint64_t* words, size_t n);
+// the amount of 1 bits of a & b, e.g. the size of the intersection of two bitmaps
+size_t bit_count_and_array(const uint64_t* a, const uint64_t* b, size_t n);
+// the position of the lowest and highest 1 bit, SIZE_MAX if there is none
+size_t lowest_bit_position_array(const uint64_t* words, size_t n);
+size_t highest_bit_position_array(const uint64_t* words, size_t n);
+
+#if BIT_BUILTINS || defined(__cpp_lib_is_constant_evaluated)
+static_assert(highest_bit_position(1u << 20) == 20 && lowest_bit_position((uint64_t)1 << 40) == 40 && bit_count(0xf0f0u) == 8 &&
+    bit_reverse(1u) == 0x80000000u && next_power_of_two(17u) == 32, "bit functions must work in constant expressions");
+#endif
+
+TEST(bits1) {
+    uint64_t r = 1;
+    DO(i, 10000) {
+        _testRandom(r);
+        const uint64_t x = r >> (i % 64);
+        const uint32_t y = (uint32_t)x;
+
+        unsigned int hi = 0, lo = 64, count = 0;
+        uint64_t reversed = 0;
+        DO(b, 64) if (x >> b & 1) {
+            hi = b;
+            lo = min(lo, (unsigned int)b);
+            count++;
+            reversed |= 1ull << (63 - b);
+        }
+        assert(highest_bit_position(x) == hi && lowest_bit_position(x) == lo && bit_count(x) == count && bit_reverse(x) == reversed);
+        assert(highest_bit_position(y) == highest_bit_position((uint64_t)y) && lowest_bit_position(y) == min(32u, lowest_bit_position((uint64_t)y)));
+        assert(bit_count(y) == bit_count((uint64_t)y) && bit_reverse(y) == (uint32_t)(bit_reverse((uint64_t)y) >> 32));
+
+        const uint64_t p = next_power_of_two(x);
+        assert(x > 1ull << 63 ? p == 0 : p >= x && bit_count(p) == 1 && (p == 1 || p / 2 < x));
+    }
+    assert(highest_bit_position(0u) == 0 && lowest_bit_position(0u) == 32 && next_power_of_two(0u) == 1 && next_power_of_two(1u << 31) == 1u << 31);
+    assert(next_power_of_two((1u << 31) + 1) == 0);
+
+    // any integer type
+    const unsigned long long ull = 1ull << 40;
+    const unsigned long ul = 1ul << 20;
+    const long long ll = -1;
+    assert(highest_bit_position(5) == 2 && highest_bit_position(ull) == 40 && highest_bit_position(ul) == 20 && highest_bit_position(ll) == 63);
+    assert(lowest_bit_position(0) == 32 && lowest_bit_position(ull) == 40 && bit_count(-1) == 32 && bit_count(ll) == 64);
+    assert(bit_reverse(1) == 0x80000000u && bit_reverse(ull) == 1ull << 23 && next_power_of_two(5) == 8u && next_power_of_two(ull + 1) == ull << 1);
+    assert(highest_bit_position((unsigned short)0x8000) == 15 && bit_count((unsigned char)0xff) == 8);
+
+    vector<uint64_t> a(1000), b(1000);
+    DO(i, a.size()) {
+        _testRandom(r);
+        a[i] = r;
+        b[i] = r * 31 ^ (r >> 17);
+    }
+    FOR1(size_t, n, 0, 40) {
+        const size_t m = n * 23; // odd lengths for the tails
+        size_t count = 0, and_count = 0;
+        DO(i, m) count += bit_count(a[i]), and_count += bit_count(a[i] & b[i]);
+        assert(bit_count_array(a.data(), m) == count && bit_count_and_array(a.data(), b.data(), m) == and_count);
+    }
+
+    vector<uint64_t> z(300, 0);
+    assert(lowest_bit_position_array(z.data(), z.size()) == SIZE_MAX && highest_bit_position_array(z.data(), z.size()) == SIZE_MAX);
+    z[137] = 0x100;
+    z[250] = 0x8000;
+    assert(lowest_bit_position_array(z.data(), z.size()) == 137 * 64 + 8 && highest_bit_position_array(z.data(), z.size()) == 250 * 64 + 15);
+    assert(lowest_bit_position_array(z.data(), 137) == SIZE_MAX && highest_bit_position_array(z.data(), 250) == 137 * 64 + 8);
+}
+
+BENCHMARK(bit_count_array) {
+    static vector<uint64_t> words(1 << 14, 0x0123456789abcdefull);
+    doNotOptimize(bit_count_array(words.data(), words.size()));
+}
+
+// Division by invariant divisors
+
+/*
+A divisor m of 32 bit unsigned integers, prepared so that dividing by it takes a multiplication and shifts instead of a division
+(Granlund, Montgomery, "Division by Invariant Integers using Multiplication", figure 4.1):
+
+with l = ceil(log2(m)) and multiplier = floor(2^32 (2^l - m) / m) + 1,
+n / m = (t + ((n - t) >> shift1)) >> shift2 for t = (multiplier * n) >> 32, shift1 = min(l, 1), shift2 = max(l - 1, 0)
+
+Worth it when the same m divides many numbers, as with mod, divisible, mod_array and divisible_mask.
+constexpr where the bit functions are, so constant divisors can be prepared at compile time.
+*/
+struct Divisor {
+    uint32_t m, multiplier;
+    unsigned int shift1, shift2;
+
+    explicit BIT_CONSTEXPR Divisor(uint32_t m) :
+        m(m),
+        multiplier((uint32_t)(((((uint64_t)1 << (m > 1 ? highest_bit_position(m - 1) + 1 : 0)) - m) << 32) / (m ? m : 1) + 1)),
+        shift1(m > 1 ? 1 : 0),
+        shift2(m > 1 ? highest_bit_position(m - 1) : 0) {
+    }
+
+    CPU_MEMBERFUNCTION(constexpr uint32_t, divide, (uint32_t n) const, "n / m", PURITY_PURE) {
+        const uint32_t t = (uint32_t)(((uint64_t)multiplier * n) >> 32);
+        return (t + ((n - t) >> shift1)) >> shift2;
+    }
+
+    CPU_MEMBERFUNCTION(constexpr uint32_t, remainder, (uint32_t n) const, "n % m", PURITY_PURE) {
+        return n - divide(n) * m;
+    }
+};
+
+#if BIT_BUILTINS || defined(__cpp_lib_is_constant_evaluated)
+static_assert(Divisor(7).divide(100) == 14 && Divisor(1).divide(5) == 5 && Divisor(0x80000001u).divide(0xffffffffu) == 1 && Divisor(3).remainder(11) == 2,
+    "Divisor must work in constant expressions");
+#endif
+
+FUNCTION(unsigned int, mod, (int n, const Divisor& m), "mod(n, m.m), see mod", PURITY_PURE) {
+    return n >= 0 ? m.remainder((uint32_t)n) : m.m - 1 - m.remainder((uint32_t)-(n + 1));
+}
+DECLARE_PURE((unsigned int(*)(int, const Divisor&))mod);
+
+template<typename T>
+FUNCTION(bool, divisible, (T n, const Divisor& m), "divisible(n, m.m) for n of at most 32 bits", PURITY_PURE) {
+    static_assert(is_integral<T>::value && sizeof(T) <= 4, "Divisor divides 32 bit integers");
+    return !m.remainder(n < 0 ? 0u - (uint32_t)n : (uint32_t)n);
+}
+
+// mod and divisible for constant m, e.g. mod<10>(n). The compiler does the same as Divisor, at compile time.
+template<unsigned int m>
+FUNCTION(unsigned int, mod, (int n), "mod(n, m), see mod", PURITY_PURE) {
+    static_assert(m > 0, "m must be positive");
+    return n >= 0 ? (unsigned int)n % m : m - 1 - (unsigned int)-(n + 1) % m;
+}
+
+template<unsigned int m, typename T>
+FUNCTION(bool, divisible, (T n), "divisible(n, m) for n of at most 32 bits", PURITY_PURE) {
+    static_assert(m > 0, "m must be positive");
+    static_assert(is_integral<T>::value && sizeof(T) <= 4, "32 bit integers only");
+    return (n < 0 ? 0u - (uint32_t)n : (uint32_t)n) % m == 0;
+}
+
+#ifdef __AVX2__
+// n / m in each of the 8 lanes
+FUNCTION(__m256i, divide_epu32, (__m256i n, const Divisor& m), "", PURITY_PURE) {
+    const __m256i multiplier = _mm256_set1_epi32((int)m.multiplier);
+    // the high halves of the 32x32 bit products, for the even and odd lanes
+    const __m256i even = _mm256_srli_epi64(_mm256_mul_epu32(n, multiplier), 32);
+    const __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(n, 32), multiplier);
+    const __m256i t = _mm256_blend_epi32(even, odd, 0xaa);
+    const __m256i q = _mm256_add_epi32(t, _mm256_srl_epi32(_mm256_sub_epi32(n, t), _mm_cvtsi32_si128((int)m.shift1)));
+    return _mm256_srl_epi32(q, _mm_cvtsi32_si128((int)m.shift2));
+}
+
+// n % m
+FUNCTION(__m256i, remainder_epu32, (__m256i n, const Divisor& m), "", PURITY_PURE) {
+    return _mm256_sub_epi32(n, _mm256_mullo_epi32(divide_epu32(n, m), _mm256_set1_epi32((int)m.m)));
+}
+#endif
+
+/*
+out[i] = mod(n[i], m) for i < count, 8 at a time with AVX2
+*/
+template<typename T>
+FUNCTION(void, mod_array, (_In_reads_(count) const T* n, size_t count, const Divisor& m, _Out_writes_(count) unsigned int* out), "", PURITY_OUTPUT_POINTERS) {
+    static_assert(is_same<T, int>::value || is_same<T, unsigned int>::value, "int or unsigned int");
+    size_t i = 0;
+#ifdef __AVX2__
+    for (; i + 8 <= count; i += 8) {
+        const __m256i x = _mm256_loadu_si256((const __m256i*)(n + i));
+        if (is_signed<T>::value) {
+            // negative n: m - 1 - (-(n + 1)) % m, with -(n + 1) = ~n
+            const __m256i negative = _mm256_srai_epi32(x, 31);
+            const __m256i r = remainder_epu32(_mm256_xor_si256(x, negative), m);
+            const __m256i flipped = _mm256_sub_epi32(_mm256_set1_epi32((int)(m.m - 1)), r);
+            _mm256_storeu_si256((__m256i*)(out + i), _mm256_blendv_epi8(r, flipped, negative));
+        }
+        else _mm256_storeu_si256((__m256i*)(out + i), remainder_epu32(x, m));
+    }
+#endif
+    for (; i < count; i++) out[i] = is_signed<T>::value ? mod((int)n[i], m) : m.remainder((uint32_t)n[i]);
+}
+
+/*
+sets bit i of the bitset mask (ceil(count / 64) words) iff divisible(n[i], m), 8 at a time with AVX2
+*/
+template<typename T>
+FUNCTION(void, divisible_mask, (_In_reads_(count) const T* n, size_t count, const Divisor& m, _Out_writes_((count + 63) / 64) uint64_t* mask), "", PURITY_OUTPUT_POINTERS) {
+    static_assert(is_same<T, int>::value || is_same<T, unsigned int>::value, "int or unsigned int");
+    memset(mask, 0, (count + 63) / 64 * sizeof(uint64_t));
+    size_t i = 0;
+#ifdef __AVX2__
+    for (; i + 8 <= count; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(n + i));
+        if (is_signed<T>::value) x = _mm256_abs_epi32(x); // -2^31 becomes 2^31 as unsigned, as it should
+        const __m256i zero = _mm256_cmpeq_epi32(remainder_epu32(x, m), _mm256_setzero_si256());
+        mask[i / 64] |= (uint64_t)_mm256_movemask_ps(_mm256_castsi256_ps(zero)) << (i % 64);
+    }
+#endif
+    for (; i < count; i++) mask[i / 64] |= (uint64_t)divisible(n[i], m) << (i % 64);
+}
+
+TEST(divisor1) {
+    const uint32_t ms[] = {1, 2, 3, 5, 6, 7, 10, 11, 16, 25, 100, 641, 1000000007u, 0x7fffffffu, 0x80000000u, 0x80000001u, 0xfffffffeu, 0xffffffffu};
+    const uint32_t ns[] = {0, 1, 2, 3, 6, 7, 99, 100, 101, 0x7fffffffu, 0x80000000u, 0x80000001u, 0xfffffffeu, 0xffffffffu};
+    for (const uint32_t m : ms) {
+        const Divisor d(m);
+        for (const uint32_t n : ns) assert(d.divide(n) == n / m && d.remainder(n) == n % m, "%u / %u", n, m);
+        uint64_t r = m;
+        DO(i, 10000) {
+            _testRandom(r);
+            const uint32_t n = (uint32_t)(r >> 32) >> (i % 32);
+            assert(d.divide(n) == n / m, "%u / %u", n, m);
+            assert(mod((int)n, d) == mod((int)n, m) && divisible((int)n, d) == ((int)n % (long long)m == 0));
+        }
+    }
+    assert(mod<7>(-1) == 6 && mod<7>(INT_MIN) == 5 && divisible<3>(-9) && !divisible<3>(10u));
+
+    vector<int> n(1003);
+    vector<unsigned int> u(n.size());
+    DO(i, n.size()) n[i] = (int)(i * 2654435761u);
+    DO(i, n.size()) u[i] = (unsigned int)n[i];
+    n[5] = INT_MIN;
+    vector<unsigned int> out(n.size()), uout(n.size());
+    vector<uint64_t> mask((n.size() + 63) / 64), umask(mask.size());
+    for (const uint32_t m : ms) {
+        const Divisor d(m);
+        mod_array(n.data(), n.size(), d, out.data());
+        mod_array(u.data(), u.size(), d, uout.data());
+        divisible_mask(n.data(), n.size(), d, mask.data());
+        divisible_mask(u.data(), u.size(), d, umask.data());
+        DO(i, n.size()) {
+            assert(out[i] == mod(n[i], m) && uout[i] == u[i] % m);
+            assert((mask[i / 64] >> (i % 64) & 1) == divisible(n[i], d) && (umask[i / 64] >> (i % 64) & 1) == (u[i] % m == 0));
+        }
+    }
+}
+
+// bucketing 4096 numbers by a divisor only known at runtime
+unsigned int _benchmark_divisor = 1000;
+
+BENCHMARK(mod_4096) {
+    static vector<int> n(4096, 123456789);
+    static vector<unsigned int> out(n.size());
+    DO(i, n.size()) out[i] = mod(n[i], _benchmark_divisor);
+    doNotOptimize(out[0]);
+}
+
+BENCHMARK(mod_array_4096) {
+    static vector<int> n(4096, 123456789);
+    static vector<unsigned int> out(n.size());
+    mod_array(n.data(), n.size(), Divisor(_benchmark_divisor), out.data());
+    doNotOptimize(out[0]);
+}
+
+template<typename In, typename Out>
+CPU_FUNCTION(
+    bool
+    ,definedQ
+    ,(_In_ const unordered_map<In, Out>& f, _In_ const In& in, _Out_opt_ Out& out)
+    ,"false if f is not defined for in.\
+    out is undefined in that case\
+    true and out is f[in] otherwise\
+    In and Out must be valid unordered_map parameters."
+    ,PURITY_OUTPUT_POINTERS
+    )
+    {
+    auto outi = f.find(in);
+    if (f.end() == outi) return false;
+    out = outi->second;
+    return true;
+}
+
+template<typename In, typename Out>
+CPU_FUNCTION(
+    bool
+    ,definedQ
+    ,(_In_ const unordered_map<In, Out>& f, _In_ const In& in)
+    ,"true iff f is defined for in.\
+    In and Out must be valid unordered_map parameters."
+    ,PURITY_PURE) {
+    auto outi = f.find(in);
+    if (f.end() == outi) return false;
+    return true;
+}
+
+template<typename In, typename Out>
+CPU_FUNCTION(
+    bool
+    ,definedQ
+    ,(_In_ const unordered_map<In, Out>& f, _In_ const In& in, _Out_opt_ const Out*& out)
+    ,"Like the out overload, but out points to f[in] instead of being a copy, and is 0 if f is not defined for in."
+    ,PURITY_OUTPUT_POINTERS
+    )
+    {
+    auto outi = f.find(in);
+    out = f.end() == outi ? 0 : &outi->second;
+    return out != 0;
+}
+
+/*
+An open addressing hash map, with the keys and values stored in one array (like Abseil's Swiss table):
+
+Every slot has a control byte, which is empty, deleted, or for full slots, 7 bits of the key's hash.
+A lookup loads the 16 control bytes at the slot the hash selects and compares them against the key's 7 bits with SSE2 at once,
+only checking keys where they match, until a group of 16 has an empty slot. Groups are probed quadratically.
+The table doubles when 7/8 full.
+
+Use with definedQ, or find, which returns a pointer to the value (0 if there is none).
+Pointers are valid until the next insertion that grows the table, or until the key is erased.
+*/
+template<typename K, typename V, typename Hash = hash<K>, typename Eq = equal_to<K>>
+class FlatHashMap {
+    static constexpr int8_t empty = -128, deleted = -2; // full slots have 0 ... 127
+    static constexpr size_t group = 16;
+    static constexpr size_t npos = ~(size_t)0;
+
+    vector<int8_t> ctrl; // capacity + group - 1, the last group - 1 mirror the first so groups can be loaded at every slot
+    pair<K, V>* slots = 0;
+    size_t capacity = 0, count = 0, growth_left = 0;
+    Hash hasher;
+    Eq eq;
+
+    // std::hash is often the identity, spread its bits
+    CPU_MEMBERFUNCTION(uint64_t, hashOf, (const K& k) const, "", PURITY_PURE) {
+        const uint64_t x = (uint64_t)hasher(k) * 0x9E3779B97F4A7C15ull;
+        return x ^ (x >> 32);
+    }
+
+    CPU_MEMBERFUNCTION(void, setCtrl, (size_t i, int8_t c), "", PURITY_OUTPUT_POINTERS) {
+        ctrl[i] = c;
+        ctrl[((i - (group - 1)) & (capacity - 1)) + (group - 1)] = c; // the mirror, or i again
+    }
+
+    CPU_MEMBERFUNCTION(size_t, findIndex, (const K& k, uint64_t h) const, "The slot holding k, npos if none", PURITY_PURE) {
+        if (!capacity) return npos;
+        const size_t mask = capacity - 1;
+        const __m128i tag = _mm_set1_epi8((char)(h & 0x7f));
+        size_t pos = (size_t)(h >> 7) & mask;
+        for (size_t step = group;; pos = (pos + step) & mask, step += group) {
+            const __m128i g = _mm_loadu_si128((const __m128i*)(ctrl.data() + pos));
+            for (unsigned int m = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(g, tag)); m; m &= m - 1) {
+                const size_t i = (pos + lowest_bit_position((uint32_t)m)) & mask;
+                if (eq(slots[i].first, k)) return i;
+            }
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8(empty)))) return npos;
+        }
+    }
+
+    CPU_MEMBERFUNCTION(size_t, findFree, (uint64_t h) const, "The first empty or deleted slot for h", PURITY_PURE) {
+        const size_t mask = capacity - 1;
+        size_t pos = (size_t)(h >> 7) & mask;
+        for (size_t step = group;; pos = (pos + step) & mask, step += group) {
+            // empty and deleted have the high bit set
+            const unsigned int m = (unsigned int)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(ctrl.data() + pos)));
+            if (m) return (pos + lowest_bit_position((uint32_t)m)) & mask;
+        }
+    }
+
+    CPU_MEMBERFUNCTION(void, rehash, (size_t new_capacity), "Moves all entries into a table of new_capacity slots, a power of two >= group", PURITY_OUTPUT_POINTERS) {
+        vector<int8_t> old_ctrl(new_capacity + group - 1, empty);
+        swap(ctrl, old_ctrl);
+        pair<K, V>* const old_slots = slots;
+        const size_t old_capacity = capacity;
+        slots = allocator<pair<K, V>>().allocate(new_capacity);
+        capacity = new_capacity;
+        DO(i, old_capacity) if (old_ctrl[i] >= 0) {
+            const uint64_t h = hashOf(old_slots[i].first);
+            const size_t j = findFree(h);
+            setCtrl(j, (int8_t)(h & 0x7f));
+            new (slots + j) pair<K, V>(move(old_slots[i]));
+            old_slots[i].~pair<K, V>();
+        }
+        if (old_slots) allocator<pair<K, V>>().deallocate(old_slots, old_capacity);
+        growth_left = capacity / 8 * 7 - count;
+    }
+
+public:
+    FlatHashMap() {}
+    FlatHashMap(const FlatHashMap&) = delete;
+    FlatHashMap& operator=(const FlatHashMap&) = delete;
+    ~FlatHashMap() {
+        clear();
+        if (slots) allocator<pair<K, V>>().deallocate(slots, capacity);
+    }
+
+    CPU_MEMBERFUNCTION(size_t, size, () const, "The amount of entries", PURITY_PURE) {
+        return count;
+    }
+
+    CPU_MEMBERFUNCTION(void, clear, (), "Erases all entries, keeping the memory", PURITY_OUTPUT_POINTERS) {
+        DO(i, capacity) if (ctrl[i] >= 0) slots[i].~pair<K, V>();
+        fill(ctrl.begin(), ctrl.end(), empty);
+        count = 0;
+        growth_left = capacity / 8 * 7;
+    }
+
+    CPU_MEMBERFUNCTION(void, reserve, (size_t n), "Makes room for n entries without growing", PURITY_OUTPUT_POINTERS) {
+        size_t c = group;
+        while (c / 8 * 7 < n) c *= 2;
+        if (c > capacity) rehash(c);
+    }
+
+    CPU_MEMBERFUNCTION(V*, find, (const K& k), "The value of k, 0 if there is none", PURITY_OUTPUT_POINTERS) {
+        const size_t i = findIndex(k, hashOf(k));
+        return i == npos ? 0 : &slots[i].second;
+    }
+
+    CPU_MEMBERFUNCTION(const V*, find, (const K& k) const, "The value of k, 0 if there is none", PURITY_PURE) {
+        const size_t i = findIndex(k, hashOf(k));
+        return i == npos ? 0 : &slots[i].second;
+    }
+
+    /*
+    out[i] = find(keys[i]) for i < n, returns how many were found.
+    hashes the keys in batches and prefetches their first groups and slots before probing,
+    so that the cache misses of a batch overlap instead of following one another.
+    Only pays off for tables larger than the caches: flatHashMap_findBatch16 takes about 0.6 times as long as flatHashMap_find16 there.
+    */
+    CPU_MEMBERFUNCTION(size_t, findBatch, (_In_reads_(n) const K* keys, size_t n, _Out_writes_(n) const V** out) const, "", PURITY_OUTPUT_POINTERS) {
+        const size_t batch = 16;
+        uint64_t h[batch];
+        size_t found = 0;
+        for (size_t b = 0; b < n; b += batch) {
+            const size_t m = min(batch, n - b);
+            DO(i, m) {
+                h[i] = hashOf(keys[b + i]);
+                if (!capacity) continue;
+                const size_t pos = (size_t)(h[i] >> 7) & (capacity - 1);
+                _mm_prefetch((const char*)(ctrl.data() + pos), _MM_HINT_T0);
+                _mm_prefetch((const char*)(slots + pos), _MM_HINT_T0);
+            }
+            DO(i, m) {
+                const size_t j = findIndex(keys[b + i], h[i]);
+                out[b + i] = j == npos ? 0 : &slots[j].second;
+                found += j != npos;
+            }
+        }
+        return found;
+    }
+
+    CPU_MEMBERFUNCTION(bool, insert, (const K& k, const V& v), "Sets the value of k to v if k has none. Returns whether it was inserted.", PURITY_OUTPUT_POINTERS) {
+        bool inserted;
+        V& value = emplace(k, inserted);
+        if (inserted) value = v;
+        return inserted;
+    }
+
+    // the value of k, default constructed if k had none
+    V& operator[](const K& k) {
+        bool inserted;
+        return emplace(k, inserted);
+    }
+
+    CPU_MEMBERFUNCTION(V&, emplace, (const K& k, _Out_ bool& inserted), "The value of k, inserting a default constructed one if there is none", PURITY_OUTPUT_POINTERS) {
+        const uint64_t h = hashOf(k);
+        const size_t i = findIndex(k, h);
+        inserted = i == npos;
+        if (!inserted) return slots[i].second;
+
+        if (!growth_left) rehash(capacity ? (count >= capacity / 16 * 7 ? capacity * 2 : capacity) : group); // or just clean up deleted slots
+        const size_t j = findFree(h);
+        growth_left -= ctrl[j] == empty;
+        setCtrl(j, (int8_t)(h & 0x7f));
+        new (slots + j) pair<K, V>(k, V());
+        count++;
+        return slots[j].second;
+    }
+
+    CPU_MEMBERFUNCTION(bool, erase, (const K& k), "Removes k, returns whether it was there", PURITY_OUTPUT_POINTERS) {
+        const size_t i = findIndex(k, hashOf(k));
+        if (i == npos) return false;
+        slots[i].~pair<K, V>();
+        setCtrl(i, deleted); // keeps probe sequences through it intact
+        count--;
+        return true;
+    }
+
+    template<typename F>
+    CPU_MEMBERFUNCTION(void, forEach, (F f) const, "Calls f(key, value) for all entries, in no particular order", PURITY_ENVIRONMENT_DEPENDENT) {
+        DO(i, capacity) if (ctrl[i] >= 0) f(slots[i].first, slots[i].second);
+    }
+};
+
+template<typename In, typename Out, typename Hash, typename Eq>
+CPU_FUNCTION(
+    bool
+    ,definedQ
+    ,(_In_ const FlatHashMap<In, Out, Hash, Eq>& f, _In_ const In& in, _Out_opt_ Out& out)
+    ,"false if f is not defined for in.\
+    out is undefined in that case\
+    true and out is f[in] otherwise"
+    ,PURITY_OUTPUT_POINTERS
+    )
+    {
+    const Out* const outp = f.find(in);
+    if (!outp) return false;
+    out = *outp;
+    return true;
+}
+
+template<typename In, typename Out, typename Hash, typename Eq>
+CPU_FUNCTION(
+    bool
+    ,definedQ
+    ,(_In_ const FlatHashMap<In, Out, Hash, Eq>& f, _In_ const In& in, _Out_opt_ const Out*& out)
+    ,"Like the out overload, but out points to f[in] instead of being a copy, and is 0 if f is not defined for in."
+    ,PURITY_OUTPUT_POINTERS
+    )
+    {
+    out = f.find(in);
+    return out != 0;
+}
+
+template<typename In, typename Out, typename Hash, typename Eq>
+CPU_FUNCTION(
+    bool
+    ,definedQ
+    ,(_In_ const FlatHashMap<In, Out, Hash, Eq>& f, _In_ const In& in)
+    ,"true iff f is defined for in."
+    ,PURITY_PURE) {
+    return f.find(in) != 0;
+}
+
+TEST(flatHashMap1) {
+    FlatHashMap<int, int> f;
+    int out;
+    assert(!definedQ(f, 1) && !definedQ(f, 1, out) && f.size() == 0);
+
+    const int n = 100000;
+    DO(i, n) {
+        const bool inserted = f.insert((int)i * 7, (int)i);
+        assert(inserted);
+    }
+    assert(!f.insert(7, 0) && f.size() == n);
+    DO(i, n) assert(definedQ(f, (int)i * 7, out) && out == (int)i);
+    assert(!definedQ(f, 3));
+
+    DO(i, n) if (i % 2) {
+        const bool erased = f.erase((int)i * 7);
+        assert(erased);
+    }
+    assert(f.size() == n / 2 && !f.erase(7));
+    const int* p;
+    assert(definedQ(f, 14, p) && *p == 2 && !definedQ(f, 7, p) && !p);
+
+    vector<int> keys;
+    DO(i, 1000) keys.push_back((int)i);
+    vector<const int*> values(keys.size());
+    assert(f.findBatch(keys.data(), keys.size(), values.data()) == 72); // multiples of 14 below 1000
+    DO(i, keys.size()) assert(values[i] ? i % 14 == 0 && *values[i] == (int)i / 7 : i % 14 != 0);
+
+    // deleted slots are reused
+    REPEAT(10) {
+        DO(i, n) f[-1 - (int)i] = 1;
+        DO(i, n) f.erase(-1 - (int)i);
+    }
+    assert(f.size() == n / 2);
+    size_t sum = 0;
+    f.forEach([&](int k, int v) {sum += k == 7 * v; });
+    assert(sum == n / 2);
+
+    FlatHashMap<string, string> s;
+    s["a"] = "b";
+    string o;
+    assert(definedQ(s, string("a"), o) && o == "b" && !definedQ(s, string("b")));
+    s.clear();
+    assert(!s.size() && !s.find("a"));
+}
+
+// random lookups in a map too large for the caches, against unordered_map
+const int _benchmark_map_size = 1 << 22;
+int _benchmark_map_key(unsigned int i) { return (int)(i * 2654435761u) & (_benchmark_map_size * 4 - 1); }
+
+BENCHMARK(unordered_map_find16) {
+    static unordered_map<int, int> f;
+    if (f.empty()) DO(i, _benchmark_map_size) f[_benchmark_map_key(i)] = (int)i;
+    REPEAT(16) doNotOptimize(f.find(_benchmark_map_key(_benchmark_input++ * 13)));
+}
+
+BENCHMARK(flatHashMap_find16) {
+    static FlatHashMap<int, int> f;
+    if (!f.size()) DO(i, _benchmark_map_size) f[_benchmark_map_key(i)] = (int)i;
+    REPEAT(16) doNotOptimize(f.find(_benchmark_map_key(_benchmark_input++ * 13)));
+}
+
+BENCHMARK(flatHashMap_findBatch16) {
+    static FlatHashMap<int, int> f;
+    if (!f.size()) DO(i, _benchmark_map_size) f[_benchmark_map_key(i)] = (int)i;
+    int keys[16];
+    const int* values[16];
+    DO(i, 16) keys[i] = _benchmark_map_key(_benchmark_input++ * 13);
+    doNotOptimize(f.findBatch(keys, 16, values));
+}
+
+/*
+Memoization of PURITY_PURE functions
+
+MEMOIZED_FUNCTION(OUTPUT, NAME, INPUTS, DOCUMENTATION, CAPACITY, PURITY)
+declares a function like CPU_FUNCTION, but NAME becomes a MemoizedFunction object which remembers
+the results of up to about CAPACITY distinct argument lists. PURITY must be PURITY_PURE:
+results of anything else cannot be reused. The uncached function remains available as NAME_uncached.
+
+The arguments, decayed to values, form the key, so they must be copyable, comparable with == and hashable with std::hash.
+The result must be copyable. Recursive calls to NAME from within the body are memoized as well.
+
+The cache is split into shards by the hash of the key, each a CLOCK (second chance) cache behind its own mutex,
+so concurrent callers rarely contend. The function is evaluated outside of the lock:
+two threads missing on the same arguments at the same time both compute the result.
+*/
+const unsigned int max_memoized_functions = 1000;
+
+class MemoizedFunctionBase {
+public:
+    const char* const name;
+    atomic<uint64_t> hits, misses, evictions;
+
+    MemoizedFunctionBase(_In_z_ const char* name);
+    virtual void clear() = 0;
+    virtual size_t size() const = 0;
+};
+
+unsigned int _nmemoized_functions = 0;
+MemoizedFunctionBase* _memoized_functions[max_memoized_functions] = {0};
+
+MemoizedFunctionBase::MemoizedFunctionBase(_In_z_ const char* name) : name(name), hits(0), misses(0), evictions(0) {
+    assert(_nmemoized_functions < max_memoized_functions);
+    _memoized_functions[_nmemoized_functions++] = this;
+}
+
+// hashes all elements of a tuple, for keying maps on argument lists
+struct TupleHash {
+    template<typename... T>
+    size_t operator()(const tuple<T...>& t) const {
+        return combine(t, index_sequence_for<T...>());
+    }
+
+private:
+    template<typename... T, size_t... I>
+    static size_t combine(const tuple<T...>& t, index_sequence<I...>) {
+        uint64_t h = 0;
+        const int each[] = {0, ((h = (h ^ (uint64_t)hash<T>()(get<I>(t))) * 0x9E3779B97F4A7C15ull), 0)...};
+        (void)each;
+        return (size_t)(h ^ (h >> 29));
+    }
+};
+
+template<typename F>
+class MemoizedFunction;
+
+template<typename R, typename... P>
+class MemoizedFunction<R(P...)> : public MemoizedFunctionBase {
+    typedef tuple<decay_t<P>...> Key;
+    static const size_t shards = 16;
+
+    struct Entry {
+        Key key;
+        R value;
+        bool referenced; // since the hand last passed
+    };
+
+    struct Shard {
+        mutex m;
+        FlatHashMap<Key, size_t, TupleHash> index; // into entries
+        vector<Entry> entries;
+        size_t hand = 0;
+    };
+
+    R(*const f)(P...);
+    const size_t shard_capacity;
+    Shard shard[shards];
+
+    CPU_MEMBERFUNCTION(void, insert, (Shard& s, const Key& k, const R& value), "Adds k, evicting the first entry not referenced since the hand passed it", PURITY_OUTPUT_POINTERS) {
+        if (s.index.find(k)) return; // computed concurrently
+        if (s.entries.size() < shard_capacity) {
+            s.index[k] = s.entries.size();
+            s.entries.push_back(Entry{k, value, false});
+            return;
+        }
+        while (s.entries[s.hand].referenced) {
+            s.entries[s.hand].referenced = false;
+            s.hand = (s.hand + 1) % shard_capacity;
+        }
+        Entry& e = s.entries[s.hand];
+        s.index.erase(e.key);
+        e.key = k;
+        e.value = value;
+        s.index[k] = s.hand;
+        s.hand = (s.hand + 1) % shard_capacity;
+        evictions.fetch_add(1, memory_order_relaxed);
+    }
+
+public:
+    MemoizedFunction(_In_z_ const char* name, R f(P...), size_t capacity) :
+        MemoizedFunctionBase(name), f(f), shard_capacity(max((size_t)1, (capacity + shards - 1) / shards)) {}
+
+    R operator()(P... p) {
+        const Key k(p...);
+        const size_t h = TupleHash()(k);
+        Shard& s = shard[(h >> 7) % shards]; // FlatHashMap uses the low bits of its own mixing of h
+        {
+            lock_guard<mutex> lock(s.m);
+            if (const size_t* i = s.index.find(k)) {
+                Entry& e = s.entries[*i];
+                e.referenced = true;
+                hits.fetch_add(1, memory_order_relaxed);
+                return e.value;
+            }
+        }
+        misses.fetch_add(1, memory_order_relaxed);
+        const R value = f(p...);
+        lock_guard<mutex> lock(s.m);
+        insert(s, k, value);
+        return value;
+    }
+
+    void clear() override {
+        for (auto& s : shard) {
+            lock_guard<mutex> lock(s.m);
+            s.index.clear();
+            s.entries.clear();
+            s.hand = 0;
+        }
+    }
+
+    size_t size() const override {
+        size_t n = 0;
+        for (auto& s : shard) {
+            lock_guard<mutex> lock(const_cast<mutex&>(s.m));
+            n += s.entries.size();
+        }
+        return n;
+    }
+};
+
+// whether the purity given to MEMOIZED_FUNCTION, as a string, is PURITY_PURE
+constexpr bool _isPurityPure(const char* purity) {
+    const char* p = "PURITY_PURE";
+    while (*p && *purity == *p) p++, purity++;
+    return !*p && !*purity;
+}
+
+#define MEMOIZED_FUNCTION(ret, name, args, usage, capacity, ...) \
+    static_assert(_isPurityPure(#__VA_ARGS__), #name ": only PURITY_PURE functions can be memoized"); \
+    ret name##_uncached args; \
+    MemoizedFunction<ret args> name(#name, name##_uncached, capacity); \
+    /** usage */ ret name##_uncached args
+
+CPU_FUNCTION(void, printMemoizationStatistics, (), "Prints the cache hits, misses, evictions and size of all memoized functions", PURITY_ENVIRONMENT_DEPENDENT) {
+    DO(i, _nmemoized_functions) {
+        const MemoizedFunctionBase& m = *_memoized_functions[i];
+        const uint64_t hits = m.hits, misses = m.misses;
+        printf("%s: %llu hits, %llu misses (%.1f%% hit rate), %llu evictions, %llu entries\n", m.name,
+            (unsigned long long)hits, (unsigned long long)misses, hits + misses ? 100. * hits / (hits + misses) : 0.,
+            (unsigned long long)m.evictions.load(), (unsigned long long)m.size());
+    }
+}
+
+atomic<int> _memoized_calls(0);
+
+MEMOIZED_FUNCTION(long long, _memoized_fibonacci, (const int n), "the nth Fibonacci number, in linear time", 1000, PURITY_PURE) {
+    _memoized_calls++;
+    return n < 2 ? n : _memoized_fibonacci(n - 1) + _memoized_fibonacci(n - 2);
+}
+
+MEMOIZED_FUNCTION(string, _memoized_repeat, (const string& s, const int n), "n copies of s", 64, PURITY_PURE) {
+    string r;
+    REPEAT(n) r += s;
+    return r;
+}
+
+TEST_SERIAL(memoized1) {
+    _memoized_fibonacci.clear();
+    _memoized_calls = 0;
+    assert(_memoized_fibonacci(90) == 2880067194370816120ll);
+    assert(_memoized_calls == 91 && _memoized_fibonacci.size() == 91);
+    assert(_memoized_fibonacci(90) == 2880067194370816120ll && _memoized_calls == 91);
+
+    // bounded, recently used entries survive
+    _memoized_repeat.clear();
+    const uint64_t evictions = _memoized_repeat.evictions, hits = _memoized_repeat.hits;
+    DO(i, 1000) {
+        assert(_memoized_repeat("x", (int)i % 100) == string(i % 100, 'x'));
+        assert(_memoized_repeat("y", 3) == "yyy");
+    }
+    assert(_memoized_repeat.size() <= 64 + 16);
+    assert(_memoized_repeat.evictions > evictions && _memoized_repeat.hits >= hits + 999);
+
+    // concurrent callers agree
+    vector<thread> threads;
+    atomic<int> wrong(0);
+    DO(t, 4) threads.push_back(thread([&, t]() {
+        DO(i, 20000) wrong += _memoized_repeat("ab", (int)((i * 7 + t) % 80)).size() != 2 * ((i * 7 + t) % 80);
+    }));
+    for (auto& t : threads) t.join();
+    assert(wrong == 0);
+}
+
+#if PAUL_CPP17
+/*
+Bulk application of pure functions
+
+map_pure<f>(in, out, n) sets out[i] = f(in[i]) and zip_pure<f>(a, b, out, n) sets out[i] = f(a[i], b[i]) for i < n,
+in chunks on the OpenMP thread pool. f is a template argument so that it is inlined into the loop over a chunk,
+which the compiler can then vectorize. f must be declared with DECLARE_PURE, which is checked at compile time:
+the elements are processed concurrently and in no particular order.
+out may be the same array as an input, but must not overlap it otherwise.
+Within a test, assertions failed by f are recorded for the test like those of any PARALLEL_FOR.
+Needs C++17.
+*/
+const size_t map_pure_grain = 4096; // elements per chunk, small arrays are processed on the calling thread
+
+template<auto f, typename In, typename Out>
+CPU_FUNCTION(void, map_pure, (_In_reads_(n) const In* in, _Out_writes_(n) Out* out, size_t n), "out[i] = f(in[i]) for i < n, in parallel", PURITY_OUTPUT_POINTERS) {
+    static_assert(declared_pure<f>::value, "map_pure: f must be declared pure, see DECLARE_PURE");
+    if (n <= map_pure_grain) {
+        for (size_t i = 0; i < n; i++) out[i] = f(in[i]);
+        return;
+    }
+    PARALLEL_FOR(size_t, b, 0, n, map_pure_grain) {
+        const size_t e = min(n, b + map_pure_grain);
+        for (size_t i = b; i < e; i++) out[i] = f(in[i]);
+    }
+}
+
+template<auto f, typename A, typename B, typename Out>
+CPU_FUNCTION(void, zip_pure, (_In_reads_(n) const A* a, _In_reads_(n) const B* b, _Out_writes_(n) Out* out, size_t n), "out[i] = f(a[i], b[i]) for i < n, in parallel", PURITY_OUTPUT_POINTERS) {
+    static_assert(declared_pure<f>::value, "zip_pure: f must be declared pure, see DECLARE_PURE");
+    if (n <= map_pure_grain) {
+        for (size_t i = 0; i < n; i++) out[i] = f(a[i], b[i]);
+        return;
+    }
+    PARALLEL_FOR(size_t, c, 0, n, map_pure_grain) {
+        const size_t e = min(n, c + map_pure_grain);
+        for (size_t i = c; i < e; i++) out[i] = f(a[i], b[i]);
+    }
+}
+
+TEST(map_pure1) {
+    for (const size_t n : {(size_t)0, (size_t)1000, (size_t)100001}) {
+        vector<int> a(n), e(n);
+        vector<unsigned int> m(n), r(n);
+        vector<uint64_t> w(n);
+        DO(i, n) a[i] = (int)(i * 2654435761u) >> 2, m[i] = 1 + (unsigned int)i % 1000, w[i] = (uint64_t)i << (i % 40);
+
+        map_pure<nextEven>(a.data(), e.data(), n);
+        DO(i, n) assert(e[i] == nextEven(a[i]));
+
+        zip_pure<(unsigned int(*)(int, unsigned int))mod>(a.data(), m.data(), r.data(), n);
+        DO(i, n) assert(r[i] == mod(a[i], m[i]));
+
+        map_pure<(unsigned int(*)(uint64_t))highest_bit_position>(w.data(), r.data(), n);
+        DO(i, n) assert(r[i] == highest_bit_position(w[i]));
+
+        map_pure<nextEven>(a.data(), a.data(), n); // in place
+        assert(a == e);
+    }
+}
+
+BENCHMARK(map_pure_nextEven_1M) {
+    static vector<int> a, e;
+    if (a.empty()) {
+        a.resize(1 << 20), e.resize(1 << 20);
+        DO(i, a.size()) a[i] = (int)(i * 2654435761u) >> 2;
+    }
+    map_pure<nextEven>(a.data(), e.data(), a.size());
+    doNotOptimize(e[_benchmark_input++ & (a.size() - 1)]);
+}
+#endif
+
+/*
+Tracing
+
+TRACE_SCOPE("name") records the begin and end of the enclosing block, TRACE_FUNCTION() does so for the current function.
+Both compile to nothing unless PAUL_TRACE is defined to 1. name must remain valid until the trace is dumped, e.g. be a literal.
+
+With PAUL_TRACE_FUNCTIONS defined to 1 and compilation with -finstrument-functions (gcc, clang),
+every function that is not inlined is traced as well, named by its symbol (link with -rdynamic to see all of them).
+Use -finstrument-functions-exclude-file-list=include/c++ to skip the standard library.
+
+Each thread appends its events to its own ring buffer of the last TRACE_BUFFER_EVENTS events, with no locks or shared writes,
+at the cost of a __rdtsc and a 32 byte store. dumpTraceJson writes them in the Chrome trace event format,
+for chrome://tracing or https://ui.perfetto.dev. Dumping while threads trace drops the events they may be overwriting.
+Buffers are never freed, so that events of finished threads can still be dumped.
+*/
+#ifndef PAUL_TRACE
+#define PAUL_TRACE 0
+#endif
+#ifndef PAUL_TRACE_FUNCTIONS
+#define PAUL_TRACE_FUNCTIONS 0
+#endif
+#ifndef TRACE_BUFFER_EVENTS
+#define TRACE_BUFFER_EVENTS (1 << 16)
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define TRACE_NOINSTRUMENT __attribute__((no_instrument_function))
+#elif PAUL_TRACE_FUNCTIONS
+#error PAUL_TRACE_FUNCTIONS needs -finstrument-functions (gcc, clang)
+#else
+#define TRACE_NOINSTRUMENT
+#endif
+
+struct TraceEvent {
+    const char* name; // 0 for events of instrumented functions, which are named by address
+    const void* address;
+    uint64_t tsc;
+    char phase; // 'B'egin or 'E'nd
+};
+
+struct TraceBuffer {
+    atomic<uint64_t> head; // number of events written, the last TRACE_BUFFER_EVENTS of them are at events[i % TRACE_BUFFER_EVENTS]
+    unsigned int tid;
+    TraceEvent events[TRACE_BUFFER_EVENTS];
+};
+
+const unsigned int max_trace_threads = 1024;
+atomic<unsigned int> _ntrace_buffers(0);
+atomic<TraceBuffer*> _trace_buffers[max_trace_threads];
+thread_local TraceBuffer* _trace_buffer = 0;
+thread_local bool _trace_busy = false; // in the instrumentation hooks, which must not trace themselves
+const uint64_t _trace_start_tsc = __rdtsc();
+const chrono::steady_clock::time_point _trace_start_time = chrono::steady_clock::now();
+
+TRACE_NOINSTRUMENT CPU_FUNCTION(TraceBuffer*, _newTraceBuffer, (), "The buffer of the calling thread, 0 if there are too many threads", PURITY_ENVIRONMENT_DEPENDENT) {
+    const unsigned int i = _ntrace_buffers.fetch_add(1);
+    if (i >= max_trace_threads) return _ntrace_buffers--, (TraceBuffer*)0;
+    TraceBuffer* const b = new TraceBuffer();
+    b->tid = i;
+    _trace_buffers[i] = b;
+    return _trace_buffer = b;
+}
+
+TRACE_NOINSTRUMENT CPU_FUNCTION(void, traceEvent, (_In_opt_z_ const char* name, const void* address, char phase), "Appends an event to the buffer of the calling thread") {
+    TraceBuffer* const b = _trace_buffer ? _trace_buffer : _newTraceBuffer();
+    if (!b) return;
+    const uint64_t h = b->head.load(memory_order_relaxed);
+    b->events[h % TRACE_BUFFER_EVENTS] = TraceEvent{name, address, __rdtsc(), phase};
+    b->head.store(h + 1, memory_order_release);
+}
+
+class TraceScope {
+    const char* const name;
+public:
+    TRACE_NOINSTRUMENT TraceScope(_In_z_ const char* name) : name(name) { traceEvent(name, 0, 'B'); }
+    TRACE_NOINSTRUMENT ~TraceScope() { traceEvent(name, 0, 'E'); }
+};
+
+#define _TRACE_CONCAT2(a, b) a##b
+#define _TRACE_CONCAT(a, b) _TRACE_CONCAT2(a, b)
+#if PAUL_TRACE
+#define TRACE_SCOPE(name) TraceScope _TRACE_CONCAT(_traceScope, __LINE__)(name)
+#define TRACE_FUNCTION() TRACE_SCOPE(__FUNCTION__)
+#else
+#define TRACE_SCOPE(name)
+#define TRACE_FUNCTION()
+#endif
+
+#if PAUL_TRACE_FUNCTIONS
+extern "C" TRACE_NOINSTRUMENT void __cyg_profile_func_enter(void* f, void*) {
+    if (_trace_busy) return;
+    _trace_busy = true;
+    traceEvent(0, f, 'B');
+    _trace_busy = false;
+}
+
+extern "C" TRACE_NOINSTRUMENT void __cyg_profile_func_exit(void* f, void*) {
+    if (_trace_busy) return;
+    _trace_busy = true;
+    traceEvent(0, f, 'E');
+    _trace_busy = false;
+}
+
+CPU_FUNCTION(string, _traceSymbol, (const void* address), "The demangled name of the function at address", PURITY_ENVIRONMENT_DEPENDENT) {
+    Dl_info info;
+    if (dladdr(address, &info) && info.dli_sname) {
+        int status;
+        char* const demangled = abi::__cxa_demangle(info.dli_sname, 0, 0, &status);
+        const string name = demangled ? demangled : info.dli_sname;
+        free(demangled);
+        return name;
+    }
+    char s[32];
+    snprintf(s, sizeof(s), "%p", address);
+    return s;
+}
+#else
+CPU_FUNCTION(string, _traceSymbol, (const void* address), "address in hex", PURITY_PURE) {
+    char s[32];
+    snprintf(s, sizeof(s), "%p", address);
+    return s;
+}
+#endif
+
+CPU_FUNCTION(void, traceClear, (), "Discards all events recorded so far. No thread may trace at the same time.") {
+    DO(i, min(_ntrace_buffers.load(), max_trace_threads)) if (TraceBuffer* const b = _trace_buffers[i]) b->head = 0;
+}
+
+CPU_FUNCTION(bool, dumpTraceJson, (_In_z_ const char* path), "Writes the events in all buffers to path in the Chrome trace event format. Returns whether that succeeded.") {
+    FILE* const f = fopen(path, "w");
+    if (!f) return false;
+
+    // __rdtsc ticks at a constant rate, measured over the whole run
+    const double us = chrono::duration<double, micro>(chrono::steady_clock::now() - _trace_start_time).count();
+    const double ticks_per_us = us > 0 ? (double)(__rdtsc() - _trace_start_tsc) / us : 1;
+
+    unordered_map<const void*, string> symbols;
+    vector<TraceEvent> events;
+    bool first = true;
+    fprintf(f, "{\"traceEvents\":[");
+    DO(t, min(_ntrace_buffers.load(), max_trace_threads)) {
+        const TraceBuffer* const b = _trace_buffers[t];
+        if (!b) continue; // being registered
+        const uint64_t head = b->head.load(memory_order_acquire);
+        const uint64_t begin = head > TRACE_BUFFER_EVENTS ? head - TRACE_BUFFER_EVENTS : 0;
+        events.assign(b->events, b->events + (head - begin)); // the ring in the wrong order, but complete
+        const uint64_t now = b->head.load(memory_order_acquire);
+        const uint64_t valid = now > TRACE_BUFFER_EVENTS ? now - TRACE_BUFFER_EVENTS : 0; // older ones might have been overwritten while copying
+
+        for (uint64_t i = max(begin, valid); i < head; i++) {
+            const TraceEvent& e = events[i % TRACE_BUFFER_EVENTS];
+            string name;
+            if (e.name) name = _jsonEscape(e.name);
+            else {
+                auto s = symbols.find(e.address);
+                if (s == symbols.end()) s = symbols.emplace(e.address, _jsonEscape(_traceSymbol(e.address))).first;
+                name = s->second;
+            }
+            fprintf(f, "%s\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":0,\"tid\":%u}", first ? "" : ",",
+                name.c_str(), e.phase, (double)(int64_t)(e.tsc - _trace_start_tsc) / ticks_per_us, b->tid);
+            first = false;
+        }
+    }
+    fprintf(f, "\n]}\n");
+    return fclose(f) == 0;
+}
+
+TEST_SERIAL(trace1) {
+    TRACE_SCOPE("trace1"); // nothing unless PAUL_TRACE
+    traceClear();
+    vector<thread> threads;
+    REPEAT(3) threads.push_back(thread([]() {
+        REPEAT(1000) {
+            TraceScope outer("trace1 outer");
+            TraceScope inner("trace1 inner");
+        }
+    }));
+    for (auto& t : threads) t.join();
+    thread([]() { REPEAT(TRACE_BUFFER_EVENTS + 11) traceEvent("trace1 wrapped", 0, 'B'); }).join();
+
+    const char* const path = "trace1.json";
+    const bool dumped = dumpTraceJson(path);
+    assert(dumped);
+    FILE* const f = fopen(path, "r");
+    assert(f);
+    string json;
+    char buffer[4096];
+    for (size_t n; (n = fread(buffer, 1, sizeof(buffer), f)) > 0;) json.append(buffer, n);
+    fclose(f);
+    remove(path);
+
+    auto count = [&](const string& s) {
+        size_t n = 0;
+        for (size_t i = json.find(s); i != string::npos; i = json.find(s, i + 1)) n++;
+        return n;
+    };
+    assert(json.find("{\"traceEvents\":[") == 0 && json.substr(json.size() - 4) == "\n]}\n");
+    assert(count("\"trace1 outer\",\"ph\":\"B\"") == 3000 && count("\"trace1 outer\",\"ph\":\"E\"") == 3000);
+    assert(count("\"trace1 inner\"") == 6000);
+    assert(count("\"trace1 wrapped\"") == TRACE_BUFFER_EVENTS);
+}
+
+BENCHMARK(trace_scope) {
+    REPEAT(16) TraceScope s("benchmark");
+}
+
+// assert as it was before _assertFailed, formatting the message inline, to compare the code it generates
+#define _assertInlined(x, commentFormat, ...) {if(!(x)) {char s[10000]; snprintf(s, sizeof(s), "%s(%i) : Assertion failed : %s.\n\t<" commentFormat ">\n", __FILE__, __LINE__, #x, __VA_ARGS__); _assertionFailed(s);}}
+
+vector<int> _benchmark_assert_input(4096, 1);
+
+BENCHMARK(assert_loop_4096) {
+    const int* const v = _benchmark_assert_input.data();
+    int sum = 0;
+    DO(i, 4096) {
+        assert(v[i] >= 0, "v[%u] = %d", i, v[i]);
+        assert(v[i] < 1000, "v[%u] = %d", i, v[i]);
+        assert(sum < 1000000, "sum = %d", sum);
+        sum += v[i];
+    }
+    doNotOptimize(sum);
+}
+
+BENCHMARK(assert_inlined_loop_4096) {
+    const int* const v = _benchmark_assert_input.data();
+    int sum = 0;
+    DO(i, 4096) {
+        _assertInlined(v[i] >= 0, "v[%u] = %d", i, v[i]);
+        _assertInlined(v[i] < 1000, "v[%u] = %d", i, v[i]);
+        _assertInlined(sum < 1000000, "sum = %d", sum);
+        sum += v[i];
+    }
+    doNotOptimize(sum);
+}
+
+TEST(assert1) {
+#if ASSERT_CHECKED
+    int evaluated = 0;
+    assert(++evaluated);
+    assert(evaluated == 1, "assert evaluates its condition once, not %d times", evaluated);
+    if (evaluated) assert(true); else assert(false); // an expression, like the standard assert
+    try {
+        assert(evaluated == 2, "evaluated = %d", evaluated);
+    } catch (const test_failure& e) {
+        assert(strstr(e.what(), "Assertion failed : evaluated == 2.\n\t<evaluated = 1>\n"), "%s", e.what());
+        evaluated++;
+    }
+    assert(evaluated == 2);
+#endif
+}